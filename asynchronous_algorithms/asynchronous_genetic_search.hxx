@@ -37,14 +37,14 @@ class GeneticAlgorithm {
 
         vector<GeneticAlgorithmIndividual*> population;
 
-        mt19937 random_number_generator;
-        uniform_real_distribution<double> random_0_1;
-
         int find_insert_position(double fitness, int min_position, int current_position, int max_position);
 
         bool is_duplicate(const vector<int> &new_individual);
 
     protected:
+        mt19937 random_number_generator;
+        uniform_real_distribution<double> random_0_1;
+
         double mutation_rate;
         double crossover_rate;
 
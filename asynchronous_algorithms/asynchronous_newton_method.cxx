@@ -23,6 +23,9 @@
 #include <iostream>
 #include <iomanip>
 
+#include <algorithm>
+#include <cmath>
+
 #include "asynchronous_algorithms/asynchronous_newton_method.hxx"
 
 #include "util/arguments.hxx"
@@ -40,11 +43,22 @@ AsynchronousNewtonMethod::~AsynchronousNewtonMethod() {
 }
 
 AsynchronousNewtonMethod::AsynchronousNewtonMethod() {
+    hessian_model = HESSIAN_FULL;
+    hessian_rank = 0;
+
+    reuse_samples = false;
+    maximum_archive_size = 0;
+
+    pipelined = false;
+    speculative_workunits = 0;
+    speculative_individuals_generated = 0;
+    speculative_direction_similarity = 0.9;
 }
 
 AsynchronousNewtonMethod::AsynchronousNewtonMethod(
                                     const vector<string> &arguments
                                 ) throw (string) {
+    pre_initialize();
     parse_arguments(arguments);
     initialize();
 }
@@ -70,6 +84,16 @@ AsynchronousNewtonMethod::pre_initialize() {
     min_bound_defined = false;
     max_bound_defined = false;
     max_failed_improvements_defined = false;
+
+    hessian_model = HESSIAN_FULL;
+    hessian_rank = 0;
+
+    reuse_samples = false;
+    maximum_archive_size = 0;
+
+    pipelined = false;
+    speculative_workunits = 0;
+    speculative_direction_similarity = 0.9;
 }
 
 AsynchronousNewtonMethod::AsynchronousNewtonMethod(
@@ -185,10 +209,51 @@ AsynchronousNewtonMethod::parse_arguments(const vector<string> &arguments) {
     cout << "minimum_regression_individuals_defined: " << minimum_regression_individuals_defined << endl;
     cout << "minimum_line_search_individuals_defined: " << minimum_line_search_individuals_defined << endl;
 
-    uint32_t rps_min = 4 * number_parameters * number_parameters;
+    string hessian_model_name;
+    if (get_argument(arguments, "--hessian_model", false, hessian_model_name)) {
+        if (hessian_model_name.compare("full") == 0) {
+            hessian_model = HESSIAN_FULL;
+        } else if (hessian_model_name.compare("diagonal") == 0) {
+            hessian_model = HESSIAN_DIAGONAL;
+        } else if (hessian_model_name.compare("block") == 0) {
+            hessian_model = HESSIAN_BLOCK;
+            get_argument_vector(arguments, "--hessian_blocks", true, hessian_blocks);
+
+            if (hessian_blocks.size() != number_parameters) {
+                cerr << "Argument '--hessian_blocks <b1, b2, .. bn>' must specify a block for each of the " << number_parameters << " parameters, it specified " << hessian_blocks.size() << "." << endl;
+                exit(1);
+            }
+        } else if (hessian_model_name.compare("low-rank") == 0) {
+            hessian_model = HESSIAN_LOW_RANK;
+            if (!get_argument(arguments, "--hessian_rank", false, hessian_rank)) {
+                hessian_rank = 2;
+                cerr << "Argument '--hessian_rank <I>' not found, using default of " << hessian_rank << "." << endl;
+            }
+        } else {
+            cerr << "Improperly specified hessian model: '" << hessian_model_name.c_str() << "'" << endl;
+            cerr << "Possibilities are:" << endl;
+            cerr << "   full" << endl;
+            cerr << "   diagonal" << endl;
+            cerr << "   block       (requires --hessian_blocks <b1, b2, .. bn>)" << endl;
+            cerr << "   low-rank    (uses --hessian_rank <I>)" << endl;
+            exit(1);
+        }
+    } else {
+        cerr << "Argument '--hessian_model <S>' not found, using default of 'full'." << endl;
+        hessian_model = HESSIAN_FULL;
+    }
+
+    uint32_t rps_min;
+    if (hessian_model == HESSIAN_FULL) rps_min = 4 * number_parameters * number_parameters;
+    else rps_min = 4 * regression_terms();
+
     if (!minimum_regression_individuals_defined &&
             (!get_argument(arguments, "--minimum_regression_individuals", false, minimum_regression_individuals) || minimum_regression_individuals  < rps_min)) {
-        cerr << "Argument '--minimum_regression_individuals <I>' not found or less than minimum, using minimum of 4 * number_parameters^2 = " << rps_min << endl;
+        if (hessian_model == HESSIAN_FULL) {
+            cerr << "Argument '--minimum_regression_individuals <I>' not found or less than minimum, using minimum of 4 * number_parameters^2 = " << rps_min << endl;
+        } else {
+            cerr << "Argument '--minimum_regression_individuals <I>' not found or less than minimum, using minimum of 4 * regression terms = " << rps_min << endl;
+        }
         minimum_regression_individuals = rps_min;
     }
 
@@ -228,6 +293,25 @@ AsynchronousNewtonMethod::parse_arguments(const vector<string> &arguments) {
         cerr << "Argument '--max_failed_improvements <I> not found, using default of 0. Search may not terminate automatically." << endl;
         max_failed_improvements = 0;
     }
+
+    reuse_samples = argument_exists(arguments, "--reuse_samples");
+    if (reuse_samples &&
+            !get_argument(arguments, "--sample_archive_size", false, maximum_archive_size)) {
+        maximum_archive_size = 4 * minimum_regression_individuals;
+        cerr << "Argument '--sample_archive_size <I>' not found, using default of 4 * minimum_regression_individuals = " << maximum_archive_size << "." << endl;
+    }
+
+    pipelined = argument_exists(arguments, "--pipelined");
+    if (pipelined) {
+        if (!get_argument(arguments, "--speculative_workunits", false, speculative_workunits)) {
+            speculative_workunits = extra_workunits;
+            cerr << "Argument '--speculative_workunits <I>' not found, using default of extra_workunits (" << speculative_workunits << ")." << endl;
+        }
+
+        if (!get_argument(arguments, "--speculative_direction_similarity", false, speculative_direction_similarity)) {
+            cerr << "Argument '--speculative_direction_similarity <F>' not found, using default of " << speculative_direction_similarity << "." << endl;
+        }
+    }
 }
 
 
@@ -236,6 +320,7 @@ AsynchronousNewtonMethod::initialize() {
     regression_individuals  = vector< vector<double> >(minimum_regression_individuals + extra_workunits, vector<double>(number_parameters, 0.0));
     regression_fitnesses    = vector<double>(minimum_regression_individuals + extra_workunits);
     regression_seeds        = vector<uint32_t>(minimum_regression_individuals + extra_workunits);
+    regression_weights      = vector<double>(minimum_regression_individuals + extra_workunits, 1.0);
 
     line_search_individuals = vector< vector<double> >(minimum_line_search_individuals + extra_workunits, vector<double>(number_parameters, 0.0));
     line_search_fitnesses   = vector<double>(minimum_line_search_individuals + extra_workunits);
@@ -255,6 +340,91 @@ AsynchronousNewtonMethod::initialize() {
 
     center_fitness = -std::numeric_limits<double>::max();
     failed_improvements = 0;
+
+    speculative_individuals.clear();
+    speculative_fitnesses.clear();
+    speculative_seeds.clear();
+    speculative_individuals_generated = 0;
+
+    archived_individuals.clear();
+    archived_fitnesses.clear();
+}
+
+/**
+ *  The number of terms fit by the regression for the hessian model, which is also the number of
+ *  regression individuals needed before the regression is solvable. For the full model this is
+ *  X = [1, x1, ... xn, 0.5*x1^2, ... 0.5*xn^2, x1*x2, ..., x(n-1)*xn].
+ */
+uint32_t
+AsynchronousNewtonMethod::regression_terms() {
+    switch (hessian_model) {
+        case HESSIAN_DIAGONAL:
+            return 1 + number_parameters + number_parameters;
+        case HESSIAN_BLOCK:
+            return block_hessian_terms(hessian_blocks);
+        case HESSIAN_LOW_RANK:
+            return 1 + number_parameters + number_parameters + (number_parameters * hessian_rank);
+        default:
+            return 1 + number_parameters + number_parameters + ((number_parameters * (number_parameters - 1)) / 2);
+    }
+}
+
+/**
+ *  Fits the hessian model to the regression individuals and calculates the newton step with the matching solver.
+ *  If weights is empty all individuals are weighted equally.
+ */
+void
+AsynchronousNewtonMethod::regression_direction(const vector< vector<double> > &individuals, const vector<double> &fitnesses, const vector<double> &weights, vector<double> &direction) throw (string) {
+    vector<double> gradient;
+
+    switch (hessian_model) {
+        case HESSIAN_DIAGONAL:
+            {
+                vector<double> hessian_diagonal;
+                randomized_diagonal_hessian(individuals, center, fitnesses, weights, hessian_diagonal, gradient);
+                diagonal_newton_step(hessian_diagonal, gradient, direction);
+            }
+            break;
+
+        case HESSIAN_BLOCK:
+            {
+                vector< vector< vector<double> > > block_hessians;
+                randomized_block_hessian(individuals, center, fitnesses, weights, hessian_blocks, block_hessians, gradient);
+                block_newton_step(hessian_blocks, block_hessians, gradient, direction);
+            }
+            break;
+
+        case HESSIAN_LOW_RANK:
+            {
+                vector<double> hessian_diagonal, eigenvalues;
+                vector< vector<double> > eigenvectors;
+                randomized_low_rank_hessian(individuals, center, fitnesses, weights, hessian_rank, hessian_diagonal, eigenvectors, eigenvalues, gradient);
+                low_rank_newton_step(hessian_diagonal, eigenvectors, eigenvalues, gradient, direction);
+            }
+            break;
+
+        default:
+            {
+                vector< vector<double> > hessian;
+                if (weights.empty()) randomized_hessian(individuals, center, fitnesses, hessian, gradient);
+                else randomized_hessian(individuals, center, fitnesses, weights, hessian, gradient);
+                newton_step(hessian, gradient, direction);
+            }
+            break;
+    }
+}
+
+uint32_t
+AsynchronousNewtonMethod::best_line_search_individual(uint32_t number_reported, double &best_fitness) {
+    uint32_t best = 0;
+    best_fitness = line_search_fitnesses[0];
+    for (uint32_t i = 1; i < number_reported; i++) {
+        if (best_fitness < line_search_fitnesses[i]) {
+            best = i;
+            best_fitness = line_search_fitnesses[i];
+        }
+    }
+    return best;
 }
 
 bool
@@ -291,6 +461,7 @@ AsynchronousNewtonMethod::generate_individuals(uint32_t &number_individuals, uin
         //resize these so they can fit all the generated workunits
         regression_individuals.resize(minimum_regression_individuals + extra_workunits, vector<double>(number_parameters));  
         regression_fitnesses.resize(minimum_regression_individuals + extra_workunits, 0.0);
+        regression_weights.assign(minimum_regression_individuals + extra_workunits, 1.0);
 
         first_workunits_generated = true;
 
@@ -301,21 +472,13 @@ AsynchronousNewtonMethod::generate_individuals(uint32_t &number_individuals, uin
         //this iteration has finished, so set the direction
         regression_individuals.resize(regression_individuals_reported);  //need to resize these so the randomized_hessian function works right
         regression_fitnesses.resize(regression_individuals_reported);
-
-        vector< vector<double> > hessian;
-        vector<double> gradient;
-        try {
-            randomized_hessian(regression_individuals, center, regression_fitnesses, hessian, gradient);
-        } catch (string err_msg) {
-            cout << "randomied hessian threw string error: " << endl;
-            cout << "\t" << err_msg << endl;
-            exit(0);
-        }
+        regression_weights.resize(regression_individuals_reported);
 
         try {
-            newton_step(hessian, gradient, line_search_direction);
+            if (reuse_samples) regression_direction(regression_individuals, regression_fitnesses, regression_weights, line_search_direction);
+            else regression_direction(regression_individuals, regression_fitnesses, vector<double>(), line_search_direction);
         } catch (string err_msg) {
-            cout << "newton step threw string error: " << endl;
+            cout << "calculating the newton step from the regression threw string error: " << endl;
             cout << "\t" << err_msg << endl;
             exit(0);
         }
@@ -339,18 +502,25 @@ AsynchronousNewtonMethod::generate_individuals(uint32_t &number_individuals, uin
         line_search_individuals_reported = 0;
         line_search_individuals.resize(minimum_line_search_individuals + extra_workunits, vector<double>(number_parameters));
 
+        if (pipelined) {
+            uint32_t merged = merge_speculative_line_search_individuals();
+            cout << "speculative line search individuals used: " << merged << endl;
+
+            number_individuals -= merged;
+            parameters.resize(number_individuals);
+        }
+
         return true;
-    } else if (line_search_individuals_reported >= minimum_line_search_individuals) {
+    } else if (this->current_iteration % 2 == 1 && line_search_individuals_reported >= minimum_line_search_individuals) {
         //odd iterations do a line search
         //this iteration has finished so set the new center 
         line_search_individuals.resize(line_search_individuals_reported);
 
-        uint32_t best = 0;
-        double best_fitness = line_search_fitnesses[0];
-        for (uint32_t i = 1; i < line_search_fitnesses.size(); i++) {
-            if (best_fitness < line_search_fitnesses[i]) best = i;
-        }
-        
+        if (reuse_samples) archive_reported_individuals();
+
+        double best_fitness;
+        uint32_t best = best_line_search_individual(line_search_individuals_reported, best_fitness);
+
         if (best_fitness > center_fitness) {
             center.assign(line_search_individuals[best].begin(), line_search_individuals[best].end());
             center_fitness = best_fitness;
@@ -371,8 +541,25 @@ AsynchronousNewtonMethod::generate_individuals(uint32_t &number_individuals, uin
 
         this->current_iteration++;
         iteration = this->current_iteration;
-        
-        number_individuals = minimum_regression_individuals + extra_workunits;
+
+        regression_individuals_reported = 0;
+        //resize these so they can fit all the generated workunits
+        regression_individuals.resize(minimum_regression_individuals + extra_workunits, vector<double>(number_parameters));  
+        regression_fitnesses.resize(minimum_regression_individuals + extra_workunits, 0.0);
+        regression_weights.assign(minimum_regression_individuals + extra_workunits, 1.0);
+
+        if (pipelined) {
+            uint32_t merged = merge_speculative_regression_individuals();
+            cout << "speculative regression individuals used: " << merged << endl;
+        }
+
+        if (reuse_samples) {
+            uint32_t reused = reuse_archived_individuals();
+            cout << "archived regression individuals reused: " << reused << endl;
+        }
+
+        //only generate enough new individuals to fill the remaining regression individuals
+        number_individuals = minimum_regression_individuals + extra_workunits - regression_individuals_reported;
         parameters.resize(number_individuals, vector<double>(number_parameters));
 
 //        cout << "generating regression workunits (" << number_individuals << ")" << endl;
@@ -382,20 +569,249 @@ AsynchronousNewtonMethod::generate_individuals(uint32_t &number_individuals, uin
             Recombination::bound_parameters(min_bound, max_bound, parameters[i]);
 //            cout << "generated parameters: " << vector_to_string(parameters[i]) << endl;
         }
-        regression_individuals_reported = 0;
-        //resize these so they can fit all the generated workunits
-        regression_individuals.resize(minimum_regression_individuals + extra_workunits, vector<double>(number_parameters));  
-        regression_fitnesses.resize(minimum_regression_individuals + extra_workunits, 0.0);
 
         return true;
     }
 
+    if (pipelined) return generate_speculative_individuals(number_individuals, iteration, parameters);
+
     return false;
 }
 
+/**
+ *  Generates individuals for the next phase (current_iteration + 1) while the current phase is still
+ *  waiting on results. At most one full phase worth of speculative individuals are generated.
+ */
+bool
+AsynchronousNewtonMethod::generate_speculative_individuals(uint32_t &number_individuals, uint32_t &iteration, vector< vector<double> > &parameters) {
+    if (!first_workunits_generated) return false;
+
+    uint32_t next_phase_individuals;
+    if (current_iteration % 2 == 0) next_phase_individuals = minimum_line_search_individuals + extra_workunits;
+    else next_phase_individuals = minimum_regression_individuals + extra_workunits;
+
+    if (speculative_individuals_generated >= next_phase_individuals) return false;
+
+    number_individuals = speculative_workunits;
+    if (speculative_individuals_generated + number_individuals > next_phase_individuals) {
+        number_individuals = next_phase_individuals - speculative_individuals_generated;
+    }
+    if (number_individuals == 0) return false;
+
+    if (current_iteration % 2 == 0) {
+        //the regression is not finished, use a provisional direction from the regression individuals reported so far
+        if (regression_individuals_reported < regression_terms()) return false;
+
+        vector< vector<double> > partial_individuals(regression_individuals.begin(), regression_individuals.begin() + regression_individuals_reported);
+        vector<double> partial_fitnesses(regression_fitnesses.begin(), regression_fitnesses.begin() + regression_individuals_reported);
+        vector<double> partial_weights;
+        if (reuse_samples) partial_weights.assign(regression_weights.begin(), regression_weights.begin() + regression_individuals_reported);
+
+        vector<double> provisional_direction;
+        try {
+            regression_direction(partial_individuals, partial_fitnesses, partial_weights, provisional_direction);
+        } catch (string err_msg) {
+            //the partial regression may not be solvable yet, wait for more results
+            return false;
+        }
+
+        parameters.resize(number_individuals, vector<double>(number_parameters));
+        for (uint32_t i = 0; i < number_individuals; i++) {
+            Recombination::random_along(center, provisional_direction, line_search_min, line_search_max, parameters[i], random_number_generator, random_0_1);
+            Recombination::bound_parameters(min_bound, max_bound, parameters[i]);
+        }
+
+    } else {
+        //the line search is not finished, generate regression individuals around the best individual reported so far
+        vector<double> projected_center(center);
+
+        if (line_search_individuals_reported > 0) {
+            double best_fitness;
+            uint32_t best = best_line_search_individual(line_search_individuals_reported, best_fitness);
+            if (best_fitness > center_fitness) projected_center = line_search_individuals[best];
+        }
+
+        parameters.resize(number_individuals, vector<double>(number_parameters));
+        for (uint32_t i = 0; i < number_individuals; i++) {
+            Recombination::random_around(projected_center, regression_radius, parameters[i], random_number_generator, random_0_1);
+            Recombination::bound_parameters(min_bound, max_bound, parameters[i]);
+        }
+    }
+
+    speculative_individuals_generated += number_individuals;
+    iteration = (current_iteration + 1) | SPECULATIVE;
+
+    return true;
+}
+
+/**
+ *  Returns true if the parameters lie (nearly) along the line search direction from the center.
+ */
+bool
+AsynchronousNewtonMethod::along_line_search_direction(const vector<double> &parameters) {
+    double dot = 0.0, offset_norm = 0.0, direction_norm = 0.0;
+    for (uint32_t j = 0; j < number_parameters; j++) {
+        double offset = parameters[j] - center[j];
+        dot += offset * line_search_direction[j];
+        offset_norm += offset * offset;
+        direction_norm += line_search_direction[j] * line_search_direction[j];
+    }
+    offset_norm = sqrt(offset_norm);
+    direction_norm = sqrt(direction_norm);
+
+    if (offset_norm == 0.0 || direction_norm == 0.0) return false;
+    return fabs(dot) / (offset_norm * direction_norm) >= speculative_direction_similarity;
+}
+
+bool
+AsynchronousNewtonMethod::within_regression_radius(const vector<double> &parameters) {
+    for (uint32_t j = 0; j < number_parameters; j++) {
+        if (fabs(parameters[j] - center[j]) > regression_radius[j]) return false;
+    }
+    return true;
+}
+
+/**
+ *  Speculative line search individuals were generated along a provisional direction. Any evaluated point
+ *  is a valid candidate for the new center, but only those lying (nearly) along the final direction are
+ *  used so the line search still samples that direction.
+ */
+uint32_t
+AsynchronousNewtonMethod::merge_speculative_line_search_individuals() {
+    uint32_t merged = 0;
+    for (uint32_t i = 0; i < speculative_individuals.size() && line_search_individuals_reported < minimum_line_search_individuals + extra_workunits; i++) {
+        if (!along_line_search_direction(speculative_individuals[i])) continue;
+
+        line_search_individuals[line_search_individuals_reported] = speculative_individuals[i];
+        line_search_fitnesses[line_search_individuals_reported] = speculative_fitnesses[i];
+        line_search_seeds[line_search_individuals_reported] = speculative_seeds[i];
+        line_search_individuals_reported++;
+        merged++;
+    }
+
+    speculative_individuals.clear();
+    speculative_fitnesses.clear();
+    speculative_seeds.clear();
+    speculative_individuals_generated = 0;
+
+    return merged;
+}
+
+/**
+ *  Speculative regression individuals were generated around a projected center, those that fall
+ *  within the regression radius of the actual new center are used for the regression.
+ */
+uint32_t
+AsynchronousNewtonMethod::merge_speculative_regression_individuals() {
+    uint32_t merged = 0;
+    for (uint32_t i = 0; i < speculative_individuals.size() && regression_individuals_reported < minimum_regression_individuals + extra_workunits; i++) {
+        if (!within_regression_radius(speculative_individuals[i])) continue;
+
+        regression_individuals[regression_individuals_reported] = speculative_individuals[i];
+        regression_fitnesses[regression_individuals_reported] = speculative_fitnesses[i];
+        regression_seeds[regression_individuals_reported] = speculative_seeds[i];
+        regression_weights[regression_individuals_reported] = 1.0;
+        regression_individuals_reported++;
+        merged++;
+    }
+
+    speculative_individuals.clear();
+    speculative_fitnesses.clear();
+    speculative_seeds.clear();
+    speculative_individuals_generated = 0;
+
+    return merged;
+}
+
+/**
+ *  Adds the individuals reported for the last regression and line search to the archive, dropping
+ *  the oldest archived individuals if it grows past the maximum archive size.
+ */
+void
+AsynchronousNewtonMethod::archive_reported_individuals() {
+    for (uint32_t i = 0; i < regression_individuals_reported && i < regression_individuals.size(); i++) {
+        archived_individuals.push_back(regression_individuals[i]);
+        archived_fitnesses.push_back(regression_fitnesses[i]);
+    }
+
+    for (uint32_t i = 0; i < line_search_individuals_reported && i < line_search_individuals.size(); i++) {
+        archived_individuals.push_back(line_search_individuals[i]);
+        archived_fitnesses.push_back(line_search_fitnesses[i]);
+    }
+
+    if (archived_individuals.size() > maximum_archive_size) {
+        uint32_t excess = archived_individuals.size() - maximum_archive_size;
+        archived_individuals.erase(archived_individuals.begin(), archived_individuals.begin() + excess);
+        archived_fitnesses.erase(archived_fitnesses.begin(), archived_fitnesses.begin() + excess);
+    }
+}
+
+/**
+ *  Moves the archived individuals within the regression radius of the center into the regression individuals,
+ *  closest first. If d is the largest distance along any parameter relative to the regression radius (0 at the
+ *  center, 1 at the edge of the radius) the individual is weighted 1 - 0.5 * d^2 in the regression.
+ *
+ *  At least regression_terms() new individuals are still needed, so that the regression remains solvable
+ *  even if the reused individuals are degenerate (e.g., line search individuals all lie along one direction).
+ */
+uint32_t
+AsynchronousNewtonMethod::reuse_archived_individuals() {
+    uint32_t terms = regression_terms();
+    if (minimum_regression_individuals <= terms + regression_individuals_reported) return 0;
+    uint32_t maximum_reused = minimum_regression_individuals - terms - regression_individuals_reported;
+
+    vector< pair<double, uint32_t> > candidates;
+    for (uint32_t i = 0; i < archived_individuals.size(); i++) {
+        double distance = 0.0;
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            double d = fabs(archived_individuals[i][j] - center[j]) / regression_radius[j];
+            if (d > distance) distance = d;
+        }
+        if (distance <= 1.0) candidates.push_back(pair<double, uint32_t>(distance, i));
+    }
+
+    sort(candidates.begin(), candidates.end());
+    if (candidates.size() > maximum_reused) candidates.resize(maximum_reused);
+
+    vector<bool> reused(archived_individuals.size(), false);
+    for (uint32_t i = 0; i < candidates.size(); i++) {
+        uint32_t position = candidates[i].second;
+
+        regression_individuals[regression_individuals_reported] = archived_individuals[position];
+        regression_fitnesses[regression_individuals_reported] = archived_fitnesses[position];
+        regression_seeds[regression_individuals_reported] = 0;
+        regression_weights[regression_individuals_reported] = 1.0 - 0.5 * candidates[i].first * candidates[i].first;
+        regression_individuals_reported++;
+
+        reused[position] = true;
+    }
+
+    //reused individuals are removed from the archive, they will be archived again with the rest of this regression
+    uint32_t current = 0;
+    for (uint32_t i = 0; i < archived_individuals.size(); i++) {
+        if (reused[i]) continue;
+        if (current != i) {
+            archived_individuals[current] = archived_individuals[i];
+            archived_fitnesses[current] = archived_fitnesses[i];
+        }
+        current++;
+    }
+    archived_individuals.resize(current);
+    archived_fitnesses.resize(current);
+
+    return candidates.size();
+}
+
 bool
 AsynchronousNewtonMethod::insert_individual(uint32_t iteration, const vector<double> &parameters, double fitness, uint32_t seed) throw (string) {
-    if (!insert_individual(iteration, parameters, fitness)) return false;
+    if (!AsynchronousNewtonMethod::insert_individual(iteration, parameters, fitness)) return false;
+
+    iteration &= ~SPECULATIVE;
+    if (iteration != this->current_iteration) {
+        //this was a speculative individual for the next phase
+        speculative_seeds.back() = seed;
+        return true;
+    }
 
     if (iteration % 2 == 0) {
         //even iterations calculate a hessian/gradient
@@ -412,6 +828,18 @@ bool
 AsynchronousNewtonMethod::insert_individual(uint32_t iteration, const vector<double> &parameters, double fitness) throw (string) {
     bool modified = false;
 
+    bool speculative = (iteration & SPECULATIVE) != 0;
+    iteration &= ~SPECULATIVE;
+
+    if (speculative && iteration == this->current_iteration) {
+        /**
+         *  A speculative individual still being evaluated when its phase started. It is only used if it
+         *  passes the same test as the speculative individuals merged when the phase started.
+         */
+        if (iteration % 2 == 0 && !within_regression_radius(parameters)) return false;
+        if (iteration % 2 == 1 && !along_line_search_direction(parameters)) return false;
+    }
+
     if (iteration == this->current_iteration) {
         if (iteration % 2 == 0 && regression_individuals_reported < minimum_regression_individuals + extra_workunits) {
             //even iterations calculate a hessian/gradient
@@ -419,10 +847,11 @@ AsynchronousNewtonMethod::insert_individual(uint32_t iteration, const vector<dou
 //            cout << "setting [regression]  " << regression_individuals_reported << " -- fitness: " << fitness << " -- parameters " << vector_to_string(parameters) << endl;
             regression_individuals[regression_individuals_reported] = parameters;
             regression_fitnesses[regression_individuals_reported] = fitness;
+            regression_weights[regression_individuals_reported] = 1.0;
             regression_individuals_reported++;
 
             modified = true;
-        } else if (line_search_individuals_reported < minimum_line_search_individuals + extra_workunits) {
+        } else if (iteration % 2 == 1 && line_search_individuals_reported < minimum_line_search_individuals + extra_workunits) {
             //odd iterations do a line search
             //
 //            cout << "setting [line search] " << line_search_individuals_reported << " -- fitness: " << fitness << " -- parameters " << vector_to_string(parameters) << endl;
@@ -432,6 +861,13 @@ AsynchronousNewtonMethod::insert_individual(uint32_t iteration, const vector<dou
 
             modified = true;
         }
+    } else if (speculative && pipelined && iteration == this->current_iteration + 1 && speculative_individuals.size() < speculative_individuals_generated) {
+        //a speculative individual for the next phase, this is used (or discarded) when the current phase completes
+        speculative_individuals.push_back(parameters);
+        speculative_fitnesses.push_back(fitness);
+        speculative_seeds.push_back(0);
+
+        modified = true;
     }
 
     return modified;
@@ -444,6 +880,7 @@ AsynchronousNewtonMethod::iterate(double (*objective_function)(const vector<doub
     cout << "   minimum_line_search_individuals: " << minimum_line_search_individuals << endl;
     cout << "   minimum_regression_individuals: " << minimum_regression_individuals << endl;
     cout << "   extra_workunits: " << extra_workunits << endl;
+    cout << "   hessian_model: " << hessian_model << endl;
     cout << "   min_bound:  " << vector_to_string(min_bound) << endl;
     cout << "   max_bound:  " << vector_to_string(max_bound) << endl;
     cout << "   center:  " << vector_to_string(center) << endl;
@@ -484,6 +921,7 @@ AsynchronousNewtonMethod::iterate(double (*objective_function)(const vector<doub
     cout << "   minimum_line_search_individuals: " << minimum_line_search_individuals << endl;
     cout << "   minimum_regression_individuals: " << minimum_regression_individuals << endl;
     cout << "   extra_workunits: " << extra_workunits << endl;
+    cout << "   hessian_model: " << hessian_model << endl;
     cout << "   min_bound:  " << vector_to_string(min_bound) << endl;
     cout << "   max_bound:  " << vector_to_string(max_bound) << endl;
     cout << "   center:  " << vector_to_string(center) << endl;
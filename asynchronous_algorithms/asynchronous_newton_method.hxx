@@ -54,9 +54,14 @@ class AsynchronousNewtonMethod {
         bool extra_workunits_defined;
         uint32_t extra_workunits;
 
+        uint16_t hessian_model;
+        vector<uint32_t> hessian_blocks;
+        uint32_t hessian_rank;
+
         vector< vector<double> > regression_individuals;
         vector<double> regression_fitnesses;
         vector<uint32_t> regression_seeds;
+        vector<double> regression_weights;
 
         vector<double> line_search_direction;
 
@@ -82,11 +87,60 @@ class AsynchronousNewtonMethod {
         bool max_failed_improvements_defined;
         uint32_t max_failed_improvements;
 
+        /**
+         *  Pipelining: while a phase is waiting on its minimum number of results, generate speculative
+         *  individuals for the next phase (tagged with (current_iteration + 1) | SPECULATIVE) so workers never sit idle.
+         *  Speculative line search individuals are generated along a direction from a partial regression,
+         *  speculative regression individuals around the best line search individual reported so far.
+         *  The speculative individuals are only kept in memory, so AsynchronousNewtonMethodDB does not allow it.
+         */
+        bool pipelined;
+        uint32_t speculative_workunits;
+        uint32_t speculative_individuals_generated;
+        double speculative_direction_similarity;
+
+        vector< vector<double> > speculative_individuals;
+        vector<double> speculative_fitnesses;
+        vector<uint32_t> speculative_seeds;
+
+        /**
+         *  Sample reuse: evaluated regression and line search individuals are kept in an archive. When a new
+         *  regression phase starts, archived individuals within the regression radius of the new center are
+         *  reused (weighted by their distance to it), so fewer new regression individuals need to be generated.
+         *  The archive is only kept in memory, so AsynchronousNewtonMethodDB does not allow it.
+         */
+        bool reuse_samples;
+        uint32_t maximum_archive_size;
+        vector< vector<double> > archived_individuals;
+        vector<double> archived_fitnesses;
+
         mt19937 random_number_generator;
         uniform_real_distribution<double> random_0_1;
 
         AsynchronousNewtonMethod();
+
+        uint32_t regression_terms();
+        void regression_direction(const vector< vector<double> > &individuals, const vector<double> &fitnesses, const vector<double> &weights, vector<double> &direction) throw (string);
+        uint32_t best_line_search_individual(uint32_t number_reported, double &best_fitness);
+
+        bool generate_speculative_individuals(uint32_t &number_individuals, uint32_t &iteration, vector< vector<double> > &parameters);
+        bool along_line_search_direction(const vector<double> &parameters);
+        bool within_regression_radius(const vector<double> &parameters);
+        uint32_t merge_speculative_line_search_individuals();
+        uint32_t merge_speculative_regression_individuals();
+
+        void archive_reported_individuals();
+        uint32_t reuse_archived_individuals();
     public:
+        //The following are the different regression models used to calculate the hessian
+        const static uint16_t HESSIAN_FULL = 0;
+        const static uint16_t HESSIAN_DIAGONAL = 1;
+        const static uint16_t HESSIAN_BLOCK = 2;
+        const static uint16_t HESSIAN_LOW_RANK = 3;
+
+        //set in the iteration of speculative individuals, so they can be told apart if they are reported after their phase starts
+        const static uint32_t SPECULATIVE = 1 << 30;
+
         ~AsynchronousNewtonMethod();
 
         AsynchronousNewtonMethod(const vector<string> &arguments) throw (string);
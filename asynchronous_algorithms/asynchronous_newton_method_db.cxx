@@ -23,6 +23,7 @@
 #include <cstdlib>
 #include <limits>
 
+#include "db_columns.hxx"
 #include "evolutionary_algorithm_db.hxx"
 #include "asynchronous_newton_method_db.hxx"
 
@@ -36,6 +37,16 @@
 
 using namespace std;
 
+/**
+ *  The columns of an asynchronous newton method, in the order construct_from_database reads them.
+ */
+static const string SEARCH_COLUMNS = "id, name, regression_radius, center, center_fitness, line_search_direction,"
+                                     " line_search_min, line_search_max, extra_workunits, minimum_line_search_individuals,"
+                                     " minimum_regression_individuals, line_search_individuals_reported,"
+                                     " regression_individuals_reported, current_iteration, maximum_iterations,"
+                                     " first_workunits_generated, min_bound, max_bound, app_id, hessian_model, hessian_blocks,"
+                                     " hessian_rank";
+
 void
 AsynchronousNewtonMethodDB::check_name(string name) throw (string) {
     if (name.substr(0,4).compare("anm_") != 0) {
@@ -53,7 +64,7 @@ AsynchronousNewtonMethodDB::AsynchronousNewtonMethodDB(MYSQL *conn, string name)
     this->conn = conn;
 
     ostringstream oss;
-    oss << "SELECT * FROM asynchronous_newton_method WHERE name = '" << name << "'";
+    oss << "SELECT " << SEARCH_COLUMNS << " FROM asynchronous_newton_method WHERE name = '" << name << "'";
 //    cout << oss.str() << endl;
 
     construct_from_database(oss.str());
@@ -63,7 +74,7 @@ AsynchronousNewtonMethodDB::AsynchronousNewtonMethodDB(MYSQL *conn, int id) thro
     this->conn = conn;
 
     ostringstream oss;
-    oss << "SELECT * FROM asynchronous_newton_method WHERE id = " << id;
+    oss << "SELECT " << SEARCH_COLUMNS << " FROM asynchronous_newton_method WHERE id = " << id;
 //    cout << oss.str() << endl;
 
     construct_from_database(oss.str());
@@ -115,6 +126,9 @@ AsynchronousNewtonMethodDB::create_tables(MYSQL *conn) throw (string) {
                 << "    `min_bound` varchar(2048) NOT NULL,"
                 << "    `max_bound` varchar(2048) NOT NULL,"
                 << "    `app_id`    int(11) NOT NULL DEFAULT '-1',"
+                << "    `hessian_model` tinyint(4) NOT NULL DEFAULT '0',"
+                << "    `hessian_blocks` varchar(2048) NOT NULL DEFAULT '',"
+                << "    `hessian_rank` int(11) NOT NULL DEFAULT '0',"
                 << "PRIMARY KEY (`id`),"
                 << "UNIQUE KEY `name` (`name`)"
                 << ") ENGINE=InnoDB AUTO_INCREMENT=0 DEFAULT CHARSET=latin1";
@@ -164,8 +178,20 @@ AsynchronousNewtonMethodDB::create_tables(MYSQL *conn) throw (string) {
     }
 }
 
+void
+AsynchronousNewtonMethodDB::upgrade_tables(MYSQL *conn) throw (string) {
+    static bool upgraded = false;
+    if (upgraded) return;
+
+    add_missing_column(conn, "asynchronous_newton_method", "hessian_model", "tinyint(4) NOT NULL DEFAULT '0'");
+    add_missing_column(conn, "asynchronous_newton_method", "hessian_blocks", "varchar(2048) NOT NULL DEFAULT ''");
+    add_missing_column(conn, "asynchronous_newton_method", "hessian_rank", "int(11) NOT NULL DEFAULT '0'");
+    upgraded = true;
+}
+
 void 
 AsynchronousNewtonMethodDB::construct_from_database(string query) throw (string) {
+    upgrade_tables(conn);
     mysql_query(conn, query.c_str());
 
     if (mysql_errno(conn) != 0) {
@@ -216,8 +242,17 @@ AsynchronousNewtonMethodDB::construct_from_database(MYSQL_ROW row) throw (string
     string_to_vector<double>(row[16], min_bound);
     string_to_vector<double>(row[17], max_bound);
     app_id = atoi(row[18]);
+    hessian_model = atoi(row[19]);
+    string_to_vector<uint32_t>(row[20], hessian_blocks);
+    hessian_rank = atoi(row[21]);
     number_parameters = min_bound.size();
 
+    if (hessian_model == HESSIAN_BLOCK && hessian_blocks.size() != number_parameters) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: asynchronous newton method '" << name << "' uses a block hessian but has " << hessian_blocks.size() << " hessian blocks for " << number_parameters << " parameters. Thrown on " << __FILE__ << ":" << __LINE__;
+        throw ex_msg.str();
+    }
+
     //Get the individual information from the database
     ostringstream oss;
     oss << "SELECT position, fitness, parameters, seed FROM anm_line_search WHERE asynchronous_newton_method_id = " << this->id << " ORDER BY position";
@@ -281,6 +316,7 @@ AsynchronousNewtonMethodDB::construct_from_database(MYSQL_ROW row) throw (string
     regression_fitnesses.resize(number_individuals, -numeric_limits<double>::max());
     regression_individuals.resize(number_individuals, vector<double>(number_parameters, 0.0));
     regression_seeds.resize(number_individuals, 0);
+    regression_weights.assign(number_individuals, 1.0);
 
     AsynchronousNewtonMethod::initialize_rng();    //to initialize the random number generator
 
@@ -327,6 +363,28 @@ AsynchronousNewtonMethodDB::construct_from_database(MYSQL_ROW row) throw (string
  */
 void
 AsynchronousNewtonMethodDB::insert_to_database() throw (string) {
+    /**
+     *  The archive of reported individuals is only kept in memory, so it would be lost whenever the
+     *  search is reloaded from the database (i.e., every time the work generator or validator runs).
+     */
+    if (reuse_samples) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: asynchronous newton method '" << name << "' uses '--reuse_samples', which is not supported for searches stored in a database. Thrown on " << __FILE__ << ":" << __LINE__;
+        throw ex_msg.str();
+    }
+
+    /**
+     *  Likewise the speculative individuals are only kept in memory, and the search is not pipelined once
+     *  it is read back.
+     */
+    if (pipelined) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: asynchronous newton method '" << name << "' uses '--pipelined', which is not supported for searches stored in a database. Thrown on " << __FILE__ << ":" << __LINE__;
+        throw ex_msg.str();
+    }
+
+    upgrade_tables(conn);
+
     ostringstream query;
 
     query << "INSERT INTO asynchronous_newton_method"
@@ -348,7 +406,10 @@ AsynchronousNewtonMethodDB::insert_to_database() throw (string) {
           << ", first_workunits_generated = " << first_workunits_generated
           << ", min_bound = '" << vector_to_string<double>(min_bound) << "'"
           << ", max_bound = '" << vector_to_string<double>(max_bound) << "'"
-          << ", app_id = " << app_id;
+          << ", app_id = " << app_id
+          << ", hessian_model = " << hessian_model
+          << ", hessian_blocks = '" << vector_to_string<uint32_t>(hessian_blocks) << "'"
+          << ", hessian_rank = " << hessian_rank;
 
     mysql_query(conn, query.str().c_str());
 
@@ -532,7 +593,16 @@ AsynchronousNewtonMethodDB::~AsynchronousNewtonMethodDB() {
 }
 
 void
-AsynchronousNewtonMethodDB::update_database_on_generate() throw (string) {
+AsynchronousNewtonMethodDB::update_database_on_generate(bool phase_started) throw (string) {
+    if (phase_started) {
+        //the individuals merged from speculative ones or reused from the archive when the phase started
+        uint32_t reported = (current_iteration % 2 == 0) ? regression_individuals_reported : line_search_individuals_reported;
+        for (uint32_t i = 0; i < reported; i++) write_individual(i);
+    }
+
+    //the results inserted before the new individuals were generated are written first
+    writes.flush();
+
     ostringstream individual_query;
     individual_query     << "UPDATE asynchronous_newton_method"
                          << " SET ";
@@ -541,7 +611,7 @@ AsynchronousNewtonMethodDB::update_database_on_generate() throw (string) {
     }
     individual_query     << "  current_iteration = " << current_iteration
                          << ", line_search_individuals_reported = " << line_search_individuals_reported
-                         << ", regression_individuals_reported = " << line_search_individuals_reported
+                         << ", regression_individuals_reported = " << regression_individuals_reported
                          << ", center_fitness = " << center_fitness
                          << ", center = '" << vector_to_string<double>(center) << "'"
                          << ", line_search_direction = '" << vector_to_string<double>(line_search_direction) << "'"
@@ -559,52 +629,52 @@ AsynchronousNewtonMethodDB::update_database_on_generate() throw (string) {
 
 bool
 AsynchronousNewtonMethodDB::generate_individuals(uint32_t &number_individuals, uint32_t &iteration, vector< vector<double> > &parameters) throw (string) {
+    uint32_t previous_iteration = current_iteration;
     bool modified = AsynchronousNewtonMethod::generate_individuals(number_individuals, iteration, parameters);
-    if (modified) update_database_on_generate();
+    if (modified) update_database_on_generate(current_iteration != previous_iteration);
     return modified;
 }
 
 bool
 AsynchronousNewtonMethodDB::generate_individuals(uint32_t &number_individuals, uint32_t &iteration, vector< vector<double> > &parameters, vector<uint32_t> &seeds) throw (string) {
+    uint32_t previous_iteration = current_iteration;
     bool modified = AsynchronousNewtonMethod::generate_individuals(number_individuals, iteration, parameters, seeds);
-    if (modified) update_database_on_generate();
+    if (modified) update_database_on_generate(current_iteration != previous_iteration);
     return modified;
 }
 
-void 
-AsynchronousNewtonMethodDB::update_database_on_insert(uint32_t id, const vector<double> &parameters, double fitness, bool using_seed, uint32_t seed) throw (string) {
-    ostringstream individual_query;
+/**
+ *  Buffers the row of the individual at position in the current phase's (regression or line search) individuals.
+ */
+void
+AsynchronousNewtonMethodDB::write_individual(uint32_t position) {
+    ostringstream individual_values;
     if (current_iteration % 2 == 0) {
-        individual_query << "UPDATE anm_regression"
-                         << " SET "
-                         << "  fitness = " << regression_fitnesses[id]
-                         << ", parameters = '" << vector_to_string<double>(regression_individuals[id]) << "'";
-        if (using_seed) {
-        individual_query << ", seed = " << regression_seeds[id];
-        }
-        individual_query << " WHERE "
-                         << "     asynchronous_newton_method_id = " << this->id
-                         << " AND position = " << id;
-    } else {
-        individual_query << "UPDATE anm_line_search"
-                         << " SET "
-                         << "  fitness = " << line_search_fitnesses[id]
-                         << ", parameters = '" << vector_to_string<double>(line_search_individuals[id]) << "'";
-        if (using_seed) {
-        individual_query << ", seed = " << line_search_seeds[id];
-        }
-        individual_query << " WHERE "
-                         << "     asynchronous_newton_method_id = " << this->id
-                         << " AND position = " << id;
-    }
+        individual_values << this->id
+                          << ", " << position
+                          << ", " << regression_fitnesses[position]
+                          << ", '" << vector_to_string<double>(regression_individuals[position]) << "'"
+                          << ", " << regression_seeds[position];
 
-    mysql_query(conn, individual_query.str().c_str());
+        writes.upsert("anm_regression", "asynchronous_newton_method_id, position, fitness, parameters, seed", position, individual_values.str());
+    } else {
+        individual_values << this->id
+                          << ", " << position
+                          << ", " << line_search_fitnesses[position]
+                          << ", '" << vector_to_string<double>(line_search_individuals[position]) << "'"
+                          << ", " << line_search_seeds[position];
 
-    if (mysql_errno(conn) != 0) {
-        ostringstream ex_msg;
-        ex_msg << "ERROR: updating individual with query: '" << individual_query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
-        throw ex_msg.str();
+        writes.upsert("anm_line_search", "asynchronous_newton_method_id, position, fitness, parameters, seed", position, individual_values.str());
     }
+}
+
+void 
+AsynchronousNewtonMethodDB::update_database_on_insert(uint32_t position, const vector<double> &parameters, double fitness, bool using_seed, uint32_t seed) throw (string) {
+    /**
+     *  The writes are buffered and coalesced by writes (see DBWriteBehind), only the last row of a
+     *  position and the last update of each count are written when it flushes.
+     */
+    write_individual(position);
 
     if (current_iteration % 2 == 0) {
         ostringstream anm_query;
@@ -614,7 +684,7 @@ AsynchronousNewtonMethodDB::update_database_on_insert(uint32_t id, const vector<
                   << " WHERE "
                   << "    id = " << this->id << endl;
 
-        mysql_query(conn, anm_query.str().c_str());
+        writes.update("asynchronous_newton_method regression", anm_query.str());
     } else {
         ostringstream anm_query;
         anm_query << " UPDATE asynchronous_newton_method"
@@ -623,20 +693,26 @@ AsynchronousNewtonMethodDB::update_database_on_insert(uint32_t id, const vector<
                   << " WHERE "
                   << "    id = " << this->id << endl;
 
-        mysql_query(conn, anm_query.str().c_str());
+        writes.update("asynchronous_newton_method line_search", anm_query.str());
     }
 
-    if (mysql_errno(conn) != 0) {
-        ostringstream ex_msg;
-        ex_msg << "ERROR: updating asynchronous_newton_method with query: '" << individual_query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
-        throw ex_msg.str();
-    }
+    writes.result_added(conn);
+}
+
+/**
+ *  The position (in the regression or line search individuals) of the individual inserted last.
+ */
+uint32_t
+AsynchronousNewtonMethodDB::reported_position() {
+    if (current_iteration % 2 == 0) return regression_individuals_reported - 1;
+    else return line_search_individuals_reported - 1;
 }
 
 bool
 AsynchronousNewtonMethodDB::insert_individual(uint32_t id, const vector<double> &parameters, double fitness) throw (string) {
     bool modified = AsynchronousNewtonMethod::insert_individual(id, parameters, fitness);
-    if (modified) update_database_on_insert(id, parameters, fitness, true, 0);
+    //speculative individuals for the next phase are only kept in memory until it starts
+    if (modified && (id & ~SPECULATIVE) == current_iteration) update_database_on_insert(reported_position(), parameters, fitness, true, 0);
     return modified;
 }
 
@@ -644,7 +720,7 @@ AsynchronousNewtonMethodDB::insert_individual(uint32_t id, const vector<double>
 bool
 AsynchronousNewtonMethodDB::insert_individual(uint32_t id, const vector<double> &parameters, double fitness, uint32_t seed) throw (string) {
     bool modified = AsynchronousNewtonMethod::insert_individual(id, parameters, fitness, seed);
-    if (modified) update_database_on_insert(id, parameters, fitness, true, seed);
+    if (modified && (id & ~SPECULATIVE) == current_iteration) update_database_on_insert(reported_position(), parameters, fitness, true, seed);
     return modified;
 }
 
@@ -738,6 +814,9 @@ AsynchronousNewtonMethodDB::print_to(ostream& stream) {
             << ", min_bound = '" << vector_to_string<double>(min_bound) << "'"
             << ", max_bound = '" << vector_to_string<double>(max_bound) << "'"
             << ", app_id = " << app_id
+            << ", hessian_model = " << hessian_model
+            << ", hessian_blocks = '" << vector_to_string<uint32_t>(hessian_blocks) << "'"
+            << ", hessian_rank = " << hessian_rank
             << "]" << endl;
 
     uint32_t number_individuals = minimum_line_search_individuals + extra_workunits;
@@ -30,6 +30,7 @@
 #include "util/statistics.hxx"
 
 #include "asynchronous_algorithms/asynchronous_newton_method.hxx"
+#include "asynchronous_algorithms/db_write_behind.hxx"
 
 using namespace std;
 
@@ -41,6 +42,9 @@ class AsynchronousNewtonMethodDB : public AsynchronousNewtonMethod {
 
         MYSQL *conn;
 
+        //the writes made when results are inserted
+        DBWriteBehind writes;
+
         void check_name(string name) throw (string);
 
         AsynchronousNewtonMethodDB();
@@ -125,12 +129,21 @@ class AsynchronousNewtonMethodDB : public AsynchronousNewtonMethod {
 
         bool is_running();
 
-        void update_database_on_generate() throw (string);
-        void update_database_on_insert(uint32_t id, const vector<double> &parameters, double fitness, bool using_seed, uint32_t seed) throw (string);
+        //see DBWriteBehind, by default every result is written through
+        void set_write_behind(uint32_t max_results, uint32_t max_seconds) { writes.set_limits(max_results, max_seconds); }
+        void flush_writes() throw (string)                              { writes.flush(); }
+
+        void update_database_on_generate(bool phase_started) throw (string);
+        uint32_t reported_position();
+        void write_individual(uint32_t position);
+        void update_database_on_insert(uint32_t position, const vector<double> &parameters, double fitness, bool using_seed, uint32_t seed) throw (string);
 
         static bool search_exists(MYSQL *conn, std::string search_name) throw (std::string);
         static void create_tables(MYSQL *conn) throw (std::string);
 
+        //adds the columns added since an older version of TAO created the tables, once per process
+        static void upgrade_tables(MYSQL *conn) throw (std::string);
+
         void construct_from_database(std::string query) throw (std::string);
         void construct_from_database(MYSQL_ROW row) throw (std::string);
         void insert_to_database() throw (std::string);           /* Insert a particle swarm into the database */
@@ -0,0 +1,61 @@
+/*
+ * Copyright 2012, 2009 Travis Desell and the University of North Dakota.
+ *
+ * This file is part of the Toolkit for Asynchronous Optimization (TAO).
+ *
+ * TAO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TAO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TAO.  If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "db_columns.hxx"
+
+/**
+ *  From MYSQL
+ */
+#include "mysql.h"
+
+using namespace std;
+
+void
+add_missing_column(MYSQL *conn, const string &table, const string &column, const string &definition) throw (string) {
+    ostringstream query;
+    query << "SHOW COLUMNS FROM `" << table << "` LIKE '" << column << "'";
+
+    mysql_query(conn, query.str().c_str());
+    MYSQL_RES *result = mysql_store_result(conn);
+
+    if (result == NULL) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: could not look up column with query: '" << query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
+        throw ex_msg.str();
+    }
+
+    bool exists = mysql_num_rows(result) > 0;
+    mysql_free_result(result);
+    if (exists) return;
+
+    ostringstream alter_query;
+    alter_query << "ALTER TABLE `" << table << "` ADD COLUMN `" << column << "` " << definition;
+
+    cout << "adding missing column with: " << endl << alter_query.str() << endl << endl;
+
+    if (mysql_query(conn, alter_query.str().c_str())) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: could not add column with query: '" << alter_query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
+        throw ex_msg.str();
+    }
+}
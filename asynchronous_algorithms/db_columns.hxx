@@ -0,0 +1,35 @@
+/*
+ * Copyright 2012, 2009 Travis Desell and the University of North Dakota.
+ *
+ * This file is part of the Toolkit for Asynchronous Optimization (TAO).
+ *
+ * TAO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TAO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TAO.  If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+#ifndef TAO_DB_COLUMNS_H
+#define TAO_DB_COLUMNS_H
+
+#include <string>
+
+#include "mysql.h"
+
+/**
+ *  Adds a column to a table created by an older version of TAO, doing nothing if the table already has it,
+ *  so the searches can read their tables by column name. The definition is as in a CREATE TABLE, e.g.:
+ *
+ *      add_missing_column(conn, "particle", "version", "int(11) NOT NULL DEFAULT '0'");
+ */
+void add_missing_column(MYSQL *conn, const std::string &table, const std::string &column, const std::string &definition) throw (std::string);
+
+#endif
@@ -0,0 +1,168 @@
+/*
+ * Copyright 2012, 2009 Travis Desell and the University of North Dakota.
+ *
+ * This file is part of the Toolkit for Asynchronous Optimization (TAO).
+ *
+ * TAO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TAO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TAO.  If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+#include <ctime>
+#include <map>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "db_write_behind.hxx"
+
+/**
+ *  From MYSQL
+ */
+#include "mysql.h"
+
+using namespace std;
+
+set<DBWriteBehind*> DBWriteBehind::buffers;
+
+DBWriteBehind::DBWriteBehind() : conn(NULL), max_results(1), max_seconds(0), pending_results(0), first_pending(0) {
+    buffers.insert(this);
+}
+
+DBWriteBehind::~DBWriteBehind() {
+    buffers.erase(this);
+}
+
+void
+DBWriteBehind::set_limits(uint32_t max_results, uint32_t max_seconds) {
+    this->max_results = max_results < 1 ? 1 : max_results;
+    this->max_seconds = max_seconds;
+}
+
+void
+DBWriteBehind::upsert(const string &table, const string &columns, uint32_t key, const string &values) {
+    upsert_columns[table] = columns;
+    upserts[table][key] = values;
+}
+
+void
+DBWriteBehind::update(const string &key, const string &statement) {
+    updates[key] = statement;
+}
+
+void
+DBWriteBehind::insert(const string &table, const string &columns, const string &values) {
+    insert_columns[table] = columns;
+    inserts[table].push_back(values);
+}
+
+bool
+DBWriteBehind::expired() {
+    return pending_results > 0 && max_seconds > 0 && time(0) - first_pending >= max_seconds;
+}
+
+void
+DBWriteBehind::result_added(MYSQL *conn) throw (string) {
+    this->conn = conn;
+    if (pending_results == 0) first_pending = time(0);
+    pending_results++;
+
+    if (pending_results >= max_results || expired()) flush();
+}
+
+void
+DBWriteBehind::query(const string &query) throw (string) {
+    mysql_query(conn, query.c_str());
+
+    if (mysql_errno(conn) != 0) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: writing to the database with query: '" << query << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
+
+        mysql_query(conn, "ROLLBACK");
+        throw ex_msg.str();
+    }
+}
+
+void
+DBWriteBehind::flush() throw (string) {
+    if (conn == NULL || (upserts.empty() && updates.empty() && inserts.empty())) {
+        pending_results = 0;
+        return;
+    }
+
+    query("START TRANSACTION");
+
+    /**
+     *  The rows of the individuals are written before the searches, so a reader that sees a search's new
+     *  version also sees the individuals with it.
+     */
+    for (map<string, map<uint32_t, string> >::iterator it = upserts.begin(); it != upserts.end(); it++) {
+        ostringstream upsert_query;
+        upsert_query << "INSERT INTO " << it->first << " (" << upsert_columns[it->first] << ") VALUES ";
+
+        for (map<uint32_t, string>::iterator row = it->second.begin(); row != it->second.end(); row++) {
+            if (row != it->second.begin()) upsert_query << ", ";
+            upsert_query << "(" << row->second << ")";
+        }
+
+        upsert_query << " ON DUPLICATE KEY UPDATE ";
+        istringstream columns(upsert_columns[it->first]);
+        string column;
+        bool first = true;
+        while (getline(columns, column, ',')) {
+            column = column.substr(column.find_first_not_of(' '));
+            if (!first) upsert_query << ", ";
+            upsert_query << column << " = VALUES(" << column << ")";
+            first = false;
+        }
+
+        query(upsert_query.str());
+    }
+
+    for (map<string, string>::iterator it = updates.begin(); it != updates.end(); it++) {
+        query(it->second);
+    }
+
+    for (map<string, vector<string> >::iterator it = inserts.begin(); it != inserts.end(); it++) {
+        ostringstream insert_query;
+        insert_query << "INSERT INTO " << it->first << " (" << insert_columns[it->first] << ") VALUES ";
+
+        for (uint32_t i = 0; i < it->second.size(); i++) {
+            if (i > 0) insert_query << ", ";
+            insert_query << "(" << it->second[i] << ")";
+        }
+
+        query(insert_query.str());
+    }
+
+    query("COMMIT");
+
+    upserts.clear();
+    updates.clear();
+    inserts.clear();
+    pending_results = 0;
+}
+
+void
+DBWriteBehind::flush_expired() throw (string) {
+    for (set<DBWriteBehind*>::iterator it = buffers.begin(); it != buffers.end(); it++) {
+        if ((*it)->expired()) (*it)->flush();
+    }
+}
+
+void
+DBWriteBehind::flush_all() throw (string) {
+    for (set<DBWriteBehind*>::iterator it = buffers.begin(); it != buffers.end(); it++) {
+        (*it)->flush();
+    }
+}
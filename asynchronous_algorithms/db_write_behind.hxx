@@ -0,0 +1,101 @@
+/*
+ * Copyright 2012, 2009 Travis Desell and the University of North Dakota.
+ *
+ * This file is part of the Toolkit for Asynchronous Optimization (TAO).
+ *
+ * TAO is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * TAO is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with TAO.  If not, see <http://www.gnu.org/licenses/>.
+ * */
+
+#ifndef TAO_DB_WRITE_BEHIND_H
+#define TAO_DB_WRITE_BEHIND_H
+
+#include <ctime>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "stdint.h"
+
+#include "mysql.h"
+
+/**
+ *  Buffers the writes a search makes to the database as results are inserted, and writes them in one
+ *  transaction once enough results are pending or the oldest has waited long enough:
+ *
+ *      rows of individuals are kept per position, only the last write of each is made (as one multi-row
+ *      INSERT ... ON DUPLICATE KEY UPDATE per table)
+ *      updates of the search are kept per key, only the last of each is made
+ *      rows appended to logs are made with one multi-row INSERT per table
+ *
+ *  A buffer is only checked against max_seconds when a result is added to it, so a process holding several
+ *  should also call flush_expired() regularly (e.g., for every result it handles) so a search that stops
+ *  getting results is still written.
+ *
+ *  By default every result is written through before insert_individual returns. Results that are still
+ *  buffered are lost if the process dies, which an asynchronous search tolerates like a lost workunit.
+ */
+class DBWriteBehind {
+    private:
+        MYSQL *conn;
+
+        uint32_t max_results;       //flush once this many results are pending
+        uint32_t max_seconds;       //flush once the oldest pending result is this old
+
+        uint32_t pending_results;
+        time_t first_pending;
+
+        std::map<std::string, std::string> upsert_columns;
+        std::map<std::string, std::map<uint32_t, std::string> > upserts;
+        std::map<std::string, std::string> updates;
+        std::map<std::string, std::string> insert_columns;
+        std::map<std::string, std::vector<std::string> > inserts;
+
+        static std::set<DBWriteBehind*> buffers;
+
+        void query(const std::string &query) throw (std::string);
+
+        bool expired();
+
+    public:
+        DBWriteBehind();
+        ~DBWriteBehind();
+
+        /**
+         *  max_results of 1 writes every result through (the default), max_seconds of 0 only flushes by count.
+         */
+        void set_limits(uint32_t max_results, uint32_t max_seconds);
+
+        //the values of the row of an individual, key is its position
+        void upsert(const std::string &table, const std::string &columns, uint32_t key, const std::string &values);
+
+        //a complete UPDATE statement, replacing any pending one with the same key
+        void update(const std::string &key, const std::string &statement);
+
+        //the values of a row appended to a table
+        void insert(const std::string &table, const std::string &columns, const std::string &values);
+
+        //called after the writes for each result, flushes (over conn) if a limit is reached
+        void result_added(MYSQL *conn) throw (std::string);
+
+        void flush() throw (std::string);
+
+        //flushes every buffer in the process whose oldest pending result is older than its max_seconds
+        static void flush_expired() throw (std::string);
+
+        //flushes every buffer in the process, for when it exits
+        static void flush_all() throw (std::string);
+};
+
+#endif
@@ -23,7 +23,11 @@
 #include <cstdlib>
 #include <limits>
 #include <iomanip>
+#include <algorithm>
+#include <map>
+#include <set>
 
+#include "db_columns.hxx"
 #include "evolutionary_algorithm_db.hxx"
 #include "differential_evolution_db.hxx"
 
@@ -38,6 +42,15 @@
 
 using namespace std;
 
+/**
+ *  The columns of a differential evolution, in the order construct_from_database and refresh_from_database read them.
+ */
+static const string SEARCH_COLUMNS = "id, name, parent_selection, number_pairs, recombination_selection, parent_scaling_factor,"
+                                     " differential_scaling_factor, crossover_rate, directional, current_individual,"
+                                     " initialized_individuals, current_iteration, maximum_iterations, individuals_created,"
+                                     " maximum_created, individuals_reported, maximum_reported, population_size, min_bound,"
+                                     " max_bound, app_id, wrap_radians, version, priority";
+
 void
 DifferentialEvolutionDB::check_name(string name) throw (string) {
     if (name.substr(0,3).compare("de_") != 0) {
@@ -55,7 +68,7 @@ DifferentialEvolutionDB::DifferentialEvolutionDB(MYSQL *conn, string name) throw
     this->conn = conn;
 
     ostringstream oss;
-    oss << "SELECT * FROM differential_evolution WHERE name = '" << name << "'";
+    oss << "SELECT " << SEARCH_COLUMNS << " FROM differential_evolution WHERE name = '" << name << "'";
 //    cout << oss.str() << endl;
 
     construct_from_database(oss.str());
@@ -65,12 +78,17 @@ DifferentialEvolutionDB::DifferentialEvolutionDB(MYSQL *conn, int id) throw (str
     this->conn = conn;
 
     ostringstream oss;
-    oss << "SELECT * FROM differential_evolution WHERE id = " << id;
+    oss << "SELECT " << SEARCH_COLUMNS << " FROM differential_evolution WHERE id = " << id;
 //    cout << oss.str() << endl;
 
     construct_from_database(oss.str());
 }
 
+DifferentialEvolutionDB::DifferentialEvolutionDB(MYSQL *conn, MYSQL_ROW row) throw (string) {
+    this->conn = conn;
+    construct_from_database(row);
+}
+
 bool
 DifferentialEvolutionDB::search_exists(MYSQL *conn, string search_name) throw (string) {
     ostringstream query;
@@ -120,6 +138,8 @@ DifferentialEvolutionDB::create_tables(MYSQL *conn) throw (string) {
                 << "    `max_bound` varchar(2048) NOT NULL,"
                 << "    `app_id`    int(11) NOT NULL DEFAULT '-1',"
                 << "    `wrap_radians` tinyint(1) NOT NULL default '0',"
+                << "    `version` int(11) NOT NULL DEFAULT '0',"
+                << "    `priority` double NOT NULL DEFAULT '1',"
                 << "PRIMARY KEY (`id`),"
                 << "UNIQUE KEY `name` (`name`)"
                 << ") ENGINE=InnoDB AUTO_INCREMENT=0 DEFAULT CHARSET=latin1";
@@ -139,6 +159,7 @@ DifferentialEvolutionDB::create_tables(MYSQL *conn) throw (string) {
                       << "    `fitness` double NOT NULL,"
                       << "    `parameters` varchar(2048) NOT NULL,"
                       << "    `seed` int(32) UNSIGNED,"
+                      << "    `version` int(11) NOT NULL DEFAULT '0',"
                       << "PRIMARY KEY (`differential_evolution_id`,`position`)"
                       << ") ENGINE=InnoDB DEFAULT CHARSET=latin1";
 
@@ -156,8 +177,20 @@ DifferentialEvolutionDB::create_tables(MYSQL *conn) throw (string) {
     }
 }
 
+void
+DifferentialEvolutionDB::upgrade_tables(MYSQL *conn) throw (string) {
+    static bool upgraded = false;
+    if (upgraded) return;
+
+    add_missing_column(conn, "differential_evolution", "version", "int(11) NOT NULL DEFAULT '0'");
+    add_missing_column(conn, "differential_evolution", "priority", "double NOT NULL DEFAULT '1'");
+    add_missing_column(conn, "de_individual", "version", "int(11) NOT NULL DEFAULT '0'");
+    upgraded = true;
+}
+
 void 
 DifferentialEvolutionDB::construct_from_database(string query) throw (string) {
+    upgrade_tables(conn);
     mysql_query(conn, query.c_str());
 
     if (mysql_errno(conn) != 0) {
@@ -217,6 +250,8 @@ DifferentialEvolutionDB::construct_from_database(MYSQL_ROW row) throw (string) {
     string_to_vector<double>(row[19], max_bound);
     app_id = atoi(row[20]);
     wrap_radians = atoi(row[21]);
+    version = atoi(row[22]);
+    priority = atof(row[23]);
     number_parameters = min_bound.size();
 
     //Get the individual information from the database
@@ -279,11 +314,64 @@ DifferentialEvolutionDB::construct_from_database(MYSQL_ROW row) throw (string) {
 }
 
 
+void
+DifferentialEvolutionDB::refresh_from_database(MYSQL_ROW row) throw (string) {
+    /**
+     *  The validator owns the reported counts and the population, while the current individual, the number
+     *  created and the seeds only change here.
+     */
+    initialized_individuals = atoi(row[10]);
+    current_iteration = max(current_iteration, (uint32_t)atoi(row[11]));
+    maximum_iterations = atoi(row[12]);
+    maximum_created = atoi(row[14]);
+    individuals_reported = atoi(row[15]);
+    maximum_reported = atoi(row[16]);
+    priority = atof(row[23]);
+
+    uint32_t row_version = atoi(row[22]);
+    if (row_version == version) return;
+
+    ostringstream oss;
+    oss << "SELECT position, fitness, parameters FROM de_individual WHERE differential_evolution_id = " << this->id << " AND version > " << version;
+    mysql_query(conn, oss.str().c_str());
+    MYSQL_RES *result = mysql_store_result(conn);
+
+    if (result == NULL) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: looking up individuals with query: '" << oss.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
+        throw ex_msg.str();
+    }
+
+    MYSQL_ROW individual_row;
+    while ((individual_row = mysql_fetch_row(result))) {
+        uint32_t individual_id = atoi(individual_row[0]);
+        if (individual_id >= population_size) continue;
+
+        fitnesses[individual_id] = atof(individual_row[1]);
+        if (fitnesses[individual_id] < -1.79768e+308) {
+            fitnesses[individual_id] = -numeric_limits<double>::max();
+        }
+        string_to_vector<double>(individual_row[2], population[individual_id]);
+
+        //individuals are only replaced by better ones, so the global best can only be replaced by a changed individual
+        if (global_best_fitness < fitnesses[individual_id]) {
+            global_best_id = individual_id;
+            global_best_fitness = fitnesses[individual_id];
+        }
+    }
+    mysql_free_result(result);
+
+    version = row_version;
+}
+
+
 /**
  *  Insert a created differential evolution to a database.
  */
 void
 DifferentialEvolutionDB::insert_to_database() throw (string) {
+    upgrade_tables(conn);
+
     ostringstream query;
 
     query.precision(10);
@@ -311,6 +399,8 @@ DifferentialEvolutionDB::insert_to_database() throw (string) {
           << ", app_id = " << app_id 
           << ", wrap_radians = " << wrap_radians;
 
+    version = 0;
+    priority = 1;
     mysql_query(conn, query.str().c_str());
 
     MYSQL_RES *result;
@@ -506,25 +596,21 @@ DifferentialEvolutionDB::insert_individual(uint32_t id, const vector<double> &pa
     bool modified = DifferentialEvolution::insert_individual(id, parameters, fitness);
 
     if (modified) {
-        ostringstream individual_query;
-        individual_query << "UPDATE de_individual"
-                         << " SET "
-                         << "  fitness = " << setprecision(10) << fitnesses[id]
-                         << ", parameters = '" << vector_to_string<double>(population[id]) << "'"
-                         << ", seed = " << seeds[id]
-                         << " WHERE "
-                         << "     differential_evolution_id = " << this->id
-                         << " AND position = " << id;
-
-        mysql_query(conn, individual_query.str().c_str());
-
-//        cout << individual_query.str() << endl;
-
-        if (mysql_errno(conn) != 0) {
-            ostringstream ex_msg;
-            ex_msg << "ERROR: updating individual with query: '" << individual_query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
-            throw ex_msg.str();
-        }
+        version++;
+
+        /**
+         *  The writes are buffered and coalesced by writes (see DBWriteBehind), only the last row of an
+         *  individual and the last update of the search are written when it flushes.
+         */
+        ostringstream individual_values;
+        individual_values << this->id
+                          << ", " << id
+                          << ", " << setprecision(10) << fitnesses[id]
+                          << ", '" << vector_to_string<double>(population[id]) << "'"
+                          << ", " << seeds[id]
+                          << ", " << version;
+
+        writes.upsert("de_individual", "differential_evolution_id, position, fitness, parameters, seed, version", id, individual_values.str());
 
         ostringstream de_query;
         de_query << " UPDATE differential_evolution"
@@ -537,46 +623,32 @@ DifferentialEvolutionDB::insert_individual(uint32_t id, const vector<double> &pa
 //                 << ", maximum_created = " << maximum_created
                  << ", individuals_reported = " << individuals_reported
 //                 << ", maximum_reported = " << maximum_reported
+                 << ", version = " << version
                  << " WHERE "
                  << "    id = " << this->id << endl;
 
-        mysql_query(conn, de_query.str().c_str());
-
-        if (mysql_errno(conn) != 0) {
-            ostringstream ex_msg;
-            ex_msg << "ERROR: updating differential_evolution with query: '" << individual_query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
-            throw ex_msg.str();
-        }
-
+        writes.update("differential_evolution", de_query.str());
 
         double best, average, median, worst;
         calculate_fitness_statistics(fitnesses, best, average, median, worst);
 
-        ostringstream log_query;
-        log_query.precision(10);
-        log_query << "INSERT INTO differential_evolution_log"
-            << " SET "
-            << "  search_id = " << this->id
-            << ", evaluation = " << this->individuals_reported
-            << ", current = '" << setprecision(10) << fitnesses[id] << "'"
-            << ", best = '" << best << "'"
-            << ", average = '" << average << "'"
-            << ", median = '" << median << "'"
-            << ", worst = '" << worst << "'"
-            << ", individual = " << id
-            << ", seed = " << seed
-            << ", global = " << setprecision(10) << (fitnesses[id] == global_best_fitness);
+        ostringstream log_values;
+        log_values.precision(10);
+        log_values << this->id
+            << ", " << this->individuals_reported
+            << ", '" << setprecision(10) << fitnesses[id] << "'"
+            << ", '" << best << "'"
+            << ", '" << average << "'"
+            << ", '" << median << "'"
+            << ", '" << worst << "'"
+            << ", " << id
+            << ", " << seed
+            << ", " << setprecision(10) << (fitnesses[id] == global_best_fitness);
 //            << ", parameters = '" << vector_to_string<double>(parameters) << "'" << endl;
 
-        mysql_query(conn, log_query.str().c_str());
-
-        if (mysql_errno(conn) != 0) {
-            ostringstream ex_msg;
-            ex_msg << "ERROR: updating differential_evolution_log with query: '" << log_query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
-            throw ex_msg.str();
-        }
-
+        writes.insert("differential_evolution_log", "search_id, evaluation, current, best, average, median, worst, individual, seed, global", log_values.str());
 
+        writes.result_added(conn);
     }
 
     return modified;
@@ -666,6 +738,77 @@ DifferentialEvolutionDB::add_unfinished_searches(MYSQL *conn, int32_t app_id, ve
     mysql_free_result(result);
 }
 
+void
+DifferentialEvolutionDB::update_unfinished_searches(MYSQL *conn, int32_t app_id, map<string, EvolutionaryAlgorithmDB*> &unfinished_searches) throw (string) {
+    upgrade_tables(conn);
+
+    ostringstream query;
+    query << "SELECT " << SEARCH_COLUMNS << " FROM differential_evolution WHERE app_id = " << app_id
+          << " AND (maximum_reported = 0 OR individuals_reported < maximum_reported)"
+          << " AND (maximum_created = 0 OR individuals_created < maximum_created)"
+          << " AND (maximum_iterations = 0 OR current_iteration < maximum_iterations)";
+
+    mysql_query(conn, query.str().c_str());
+    MYSQL_RES *result = mysql_store_result(conn);
+
+    if (mysql_errno(conn) != 0) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: getting unfinished searches with query: '" << query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
+        throw ex_msg.str();
+    }   
+
+    set<string> current_names;
+    MYSQL_ROW search_row;
+
+    while ((search_row = mysql_fetch_row(result))) {
+        string search_name = search_row[1];
+        current_names.insert(search_name);
+
+        DifferentialEvolutionDB *search = NULL;
+        map<string, EvolutionaryAlgorithmDB*>::iterator it = unfinished_searches.find(search_name);
+        if (it != unfinished_searches.end()) search = dynamic_cast<DifferentialEvolutionDB*>(it->second);
+
+        /**
+         *  A search that was recreated, or whose population or bounds were changed, is read in full again
+         */
+        vector<double> row_min_bound, row_max_bound;
+        string_to_vector<double>(search_row[18], row_min_bound);
+        string_to_vector<double>(search_row[19], row_max_bound);
+
+        if (search != NULL && (search->id != (uint32_t)atoi(search_row[0])
+                    || search->population_size != (uint32_t)atoi(search_row[17])
+                    || search->min_bound != row_min_bound
+                    || search->max_bound != row_max_bound
+                    || search->version > (uint32_t)atoi(search_row[22]))) {
+            delete search;
+            unfinished_searches.erase(it);
+            search = NULL;
+        }
+
+        if (search == NULL) {
+            unfinished_searches[search_name] = new DifferentialEvolutionDB(conn, search_row);
+        } else {
+            search->refresh_from_database(search_row);
+        }
+    }   
+    mysql_free_result(result);
+
+    /**
+     *  Remove the differential evolutions that finished or were deleted
+     */
+    map<string, EvolutionaryAlgorithmDB*>::iterator it = unfinished_searches.begin();
+    while (it != unfinished_searches.end()) {
+        DifferentialEvolutionDB *search = dynamic_cast<DifferentialEvolutionDB*>(it->second);
+
+        if (search != NULL && (current_names.count(it->first) == 0 || !search->is_running())) {
+            delete search;
+            unfinished_searches.erase(it++);
+        } else {
+            it++;
+        }
+    }
+}
+
 void
 DifferentialEvolutionDB::print_to(ostream& stream) {
     stream  << "[DifferentialEvolutionDB " << endl
@@ -24,6 +24,8 @@
 #include <fstream>
 
 #include <random>
+#include <limits>
+#include <algorithm>
 using std::mt19937;
 using std::uniform_real_distribution;
 
@@ -47,6 +49,42 @@ EvolutionaryAlgorithm::set_log_file(ofstream *log_file) {
     this->log_file = log_file;
 }
 
+uint32_t
+EvolutionaryAlgorithm::get_remaining_individuals() {
+    uint64_t remaining = numeric_limits<uint32_t>::max();
+
+    if (maximum_created > 0) {
+        remaining = min(remaining, (uint64_t)(individuals_created < maximum_created ? maximum_created - individuals_created : 0));
+    }
+
+    if (maximum_reported > 0) {
+        /**
+         *  The individuals created but not yet reported are still outstanding and will count towards
+         *  maximum_reported when they return. A search short of maximum_reported always needs at least one
+         *  more, so it is not stalled by results that never come back.
+         */
+        uint64_t outstanding = individuals_created > individuals_reported ? individuals_created - individuals_reported : 0;
+        uint64_t reported_remaining = 0;
+
+        if ((uint64_t)individuals_reported + outstanding < maximum_reported) {
+            reported_remaining = maximum_reported - individuals_reported - outstanding;
+        } else if (individuals_reported < maximum_reported) {
+            reported_remaining = 1;
+        }
+        remaining = min(remaining, reported_remaining);
+    }
+
+    if (maximum_iterations > 0) {
+        uint64_t iteration_remaining = 0;
+        if (current_iteration < maximum_iterations) {
+            iteration_remaining = ((uint64_t)(maximum_iterations - current_iteration) * population_size) - current_individual;
+        }
+        remaining = min(remaining, iteration_remaining);
+    }
+
+    return remaining;
+}
+
 void
 EvolutionaryAlgorithm::initialize_rng() {
     random_number_generator = mt19937(time(0));
@@ -78,6 +78,7 @@ class EvolutionaryAlgorithm {
         uint32_t get_current_individual()   { return current_individual; }
         uint32_t get_current_iteration()    { return current_iteration; }
         uint32_t get_individuals_created()  { return individuals_created; }
+        uint32_t get_individuals_reported() { return individuals_reported; }
         uint32_t get_number_parameters()    { return number_parameters; }
 
         bool is_running() {
@@ -87,6 +88,12 @@ class EvolutionaryAlgorithm {
 
         }
 
+        /**
+         *  How many more individuals the search needs before one of its maximums is reached, or the largest
+         *  uint32_t if it has none. Results that are still outstanding are counted against maximum_reported.
+         */
+        uint32_t get_remaining_individuals();
+
         void set_log_file(std::ofstream *log_file);
 
         /**
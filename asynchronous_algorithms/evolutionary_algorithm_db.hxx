@@ -27,15 +27,37 @@
 
 #include "stdint.h"
 
+#include "db_write_behind.hxx"
+
 class EvolutionaryAlgorithmDB {
     protected:
         uint32_t id;
         int32_t app_id;
         std::string name;
 
+        /**
+         *  Incremented with each result inserted into the search, the rows of the individuals the result
+         *  changed are given the new version so a search kept in memory only needs to read those back.
+         */
+        uint32_t version;
+
+        //the share of the work generator's jobs the search gets is weighted by this, 0 pauses the search
+        double priority;
+
+        //the writes made when results are inserted
+        DBWriteBehind writes;
+
     public:
         uint32_t get_id()        { return id; }
         std::string get_name()  { return name; }
+        double get_priority()   { return priority; }
+
+        //see DBWriteBehind, by default every result is written through
+        void set_write_behind(uint32_t max_results, uint32_t max_seconds) { writes.set_limits(max_results, max_seconds); }
+        void flush_writes() throw (std::string)                         { writes.flush(); }
+
+        virtual uint32_t get_individuals_reported() = 0;
+        virtual uint32_t get_remaining_individuals() = 0;
 
         virtual void new_individual(uint32_t &id, std::vector<double> &parameters) throw (std::string) = 0;
         virtual void new_individual(uint32_t &id, std::vector<double> &parameters, uint32_t &seed) throw (std::string) = 0;
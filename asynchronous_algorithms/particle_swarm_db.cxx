@@ -23,7 +23,11 @@
 #include <cstdlib>
 #include <limits>
 #include <iomanip>
+#include <algorithm>
+#include <map>
+#include <set>
 
+#include "db_columns.hxx"
 #include "evolutionary_algorithm_db.hxx"
 #include "particle_swarm_db.hxx"
 
@@ -38,6 +42,14 @@
 
 using namespace std;
 
+/**
+ *  The columns of a particle swarm, in the order construct_from_database and refresh_from_database read them.
+ */
+static const string SEARCH_COLUMNS = "id, name, inertia, global_best_weight, local_best_weight, initial_velocity_scale,"
+                                     " current_individual, initialized_individuals, current_iteration, maximum_iterations,"
+                                     " individuals_created, maximum_created, individuals_reported, maximum_reported,"
+                                     " population_size, min_bound, max_bound, app_id, wrap_radians, version, priority";
+
 void
 ParticleSwarmDB::check_name(string name) throw (string) {
     if (name.substr(0,3).compare("ps_") != 0) {
@@ -56,7 +68,7 @@ ParticleSwarmDB::ParticleSwarmDB(MYSQL *conn, string name) throw (string) {
     this->conn = conn;
 
     ostringstream oss;
-    oss << "SELECT * FROM particle_swarm WHERE name = '" << name << "'";
+    oss << "SELECT " << SEARCH_COLUMNS << " FROM particle_swarm WHERE name = '" << name << "'";
 //    cout << oss.str() << endl;
 
     construct_from_database(oss.str());
@@ -66,12 +78,17 @@ ParticleSwarmDB::ParticleSwarmDB(MYSQL *conn, int id) throw (string) {
     this->conn = conn;
 
     ostringstream oss;
-    oss << "SELECT * FROM particle_swarm WHERE id = " << id;
+    oss << "SELECT " << SEARCH_COLUMNS << " FROM particle_swarm WHERE id = " << id;
 //    cout << oss.str() << endl;
 
     construct_from_database(oss.str());
 }
 
+ParticleSwarmDB::ParticleSwarmDB(MYSQL *conn, MYSQL_ROW row) throw (string) {
+    this->conn = conn;
+    construct_from_database(row);
+}
+
 bool
 ParticleSwarmDB::search_exists(MYSQL *conn, std::string search_name) throw (std::string) {
     ostringstream query;
@@ -118,6 +135,8 @@ ParticleSwarmDB::create_tables(MYSQL *conn) throw (string) {
                 << "    `max_bound` varchar(2048) NOT NULL,"
                 << "    `app_id`    int(11) NOT NULL DEFAULT '-1',"
                 << "    `wrap_radians` tinyint(1) NOT NULL default '0',"
+                << "    `version` int(11) NOT NULL DEFAULT '0',"
+                << "    `priority` double NOT NULL DEFAULT '1',"
                 << "PRIMARY KEY (`id`),"
                 << "UNIQUE KEY `name` (`name`)"
                 << ") ENGINE=InnoDB AUTO_INCREMENT=0 DEFAULT CHARSET=latin1";
@@ -139,6 +158,7 @@ ParticleSwarmDB::create_tables(MYSQL *conn) throw (string) {
                     << "    `velocity` varchar(2048) NOT NULL,"
                     << "    `local_best` varchar(2048) NOT NULL,"
                     << "    `seed` int(32) UNSIGNED,"
+                    << "    `version` int(11) NOT NULL DEFAULT '0',"
                     << "PRIMARY KEY (`particle_swarm_id`,`position`)"
                     << ") ENGINE=InnoDB DEFAULT CHARSET=latin1";
 
@@ -151,8 +171,20 @@ ParticleSwarmDB::create_tables(MYSQL *conn) throw (string) {
     }
 }
 
+void
+ParticleSwarmDB::upgrade_tables(MYSQL *conn) throw (string) {
+    static bool upgraded = false;
+    if (upgraded) return;
+
+    add_missing_column(conn, "particle_swarm", "version", "int(11) NOT NULL DEFAULT '0'");
+    add_missing_column(conn, "particle_swarm", "priority", "double NOT NULL DEFAULT '1'");
+    add_missing_column(conn, "particle", "version", "int(11) NOT NULL DEFAULT '0'");
+    upgraded = true;
+}
+
 void 
 ParticleSwarmDB::construct_from_database(string query) throw (string) {
+    upgrade_tables(conn);
     mysql_query(conn, query.c_str());
 
     if (mysql_errno(conn) != 0) {
@@ -216,6 +248,8 @@ ParticleSwarmDB::construct_from_database(MYSQL_ROW row) throw (string) {
     string_to_vector<double>(row[16], max_bound);
     app_id = atoi(row[17]);
     wrap_radians = atoi(row[18]);
+    version = atoi(row[19]);
+    priority = atof(row[20]);
     number_parameters = min_bound.size();
 
     //Get the particle information from the database
@@ -284,11 +318,64 @@ ParticleSwarmDB::construct_from_database(MYSQL_ROW row) throw (string) {
 }
 
 
+void
+ParticleSwarmDB::refresh_from_database(MYSQL_ROW row) throw (string) {
+    /**
+     *  The validator owns the reported counts and the local bests, while the current individual, the number
+     *  created and the particles' positions and velocities only change here.
+     */
+    initialized_individuals = atoi(row[7]);
+    current_iteration = max(current_iteration, (uint32_t)atoi(row[8]));
+    maximum_iterations = atoi(row[9]);
+    maximum_created = atoi(row[11]);
+    individuals_reported = atoi(row[12]);
+    maximum_reported = atoi(row[13]);
+    priority = atof(row[20]);
+
+    uint32_t row_version = atoi(row[19]);
+    if (row_version == version) return;
+
+    ostringstream oss;
+    oss << "SELECT position, local_best_fitness, local_best FROM particle WHERE particle_swarm_id = " << this->id << " AND version > " << version;
+    mysql_query(conn, oss.str().c_str());
+    MYSQL_RES *result = mysql_store_result(conn);
+
+    if (result == NULL) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: looking up particles with query: '" << oss.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
+        throw ex_msg.str();
+    }
+
+    MYSQL_ROW particle_row;
+    while ((particle_row = mysql_fetch_row(result))) {
+        uint32_t particle_id = atoi(particle_row[0]);
+        if (particle_id >= population_size) continue;
+
+        local_best_fitnesses[particle_id] = atof(particle_row[1]);
+        if (local_best_fitnesses[particle_id] < -1.79768e+308) {
+            local_best_fitnesses[particle_id] = -numeric_limits<double>::max();
+        }
+        string_to_vector<double>(particle_row[2], local_bests[particle_id]);
+
+        //local bests only improve, so the global best can only be replaced by a changed particle
+        if (global_best_fitness < local_best_fitnesses[particle_id]) {
+            global_best.assign(local_bests[particle_id].begin(), local_bests[particle_id].end());
+            global_best_fitness = local_best_fitnesses[particle_id];
+        }
+    }
+    mysql_free_result(result);
+
+    version = row_version;
+}
+
+
 /**
  *  Insert a created particle swarm to a database.
  */
 void
 ParticleSwarmDB::insert_to_database() throw (string) {
+    upgrade_tables(conn);
+
     ostringstream query;
 
     query.precision(10);
@@ -313,6 +400,8 @@ ParticleSwarmDB::insert_to_database() throw (string) {
           << ", app_id = " << app_id
           << ", wrap_radians = " << wrap_radians;
 
+    version = 0;
+    priority = 1;
     mysql_query(conn, query.str().c_str());
 
     MYSQL_RES *result;
@@ -487,11 +576,13 @@ ParticleSwarmDB::~ParticleSwarmDB() {
 void
 ParticleSwarmDB::new_individual(uint32_t &id, vector<double> &parameters, uint32_t &seed) throw (string) {
     ParticleSwarm::new_individual(id, parameters, seed);
+    generated_positions.push_back(id);
 }
 
 void
 ParticleSwarmDB::new_individual(uint32_t &id, vector<double> &parameters) throw (string) {
     ParticleSwarm::new_individual(id, parameters);
+    generated_positions.push_back(id);
 }
 
 bool
@@ -499,28 +590,23 @@ ParticleSwarmDB::insert_individual(uint32_t id, const vector<double> &parameters
     bool modified = ParticleSwarm::insert_individual(id, parameters, fitness);
 
     if (modified) {
-//        MYSQL_RES *result;
-        ostringstream particle_query;
-        particle_query << "UPDATE particle"
-                       << " SET "
-                       << "  local_best_fitness = " << setprecision(10) << local_best_fitnesses[id]
-                       << ", parameters = '" << vector_to_string<double>(particles[id]) << "'"
-                       << ", velocity = '" << vector_to_string<double>(velocities[id]) << "'"
-                       << ", local_best = '" << vector_to_string<double>(local_bests[id]) << "'"
-                       << ", seed = " << seeds[id]
-                       << " WHERE "
-                       << "     particle_swarm_id = " << this->id
-                       << " AND position = " << id;
-
-        mysql_query(conn, particle_query.str().c_str());
-//        result = mysql_store_result(conn);
-
-        if (mysql_errno(conn) != 0) {
-            ostringstream ex_msg;
-            ex_msg << "ERROR: updating particle with query: '" << particle_query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
-            throw ex_msg.str();
-        }
-//        mysql_free_result(result);
+        version++;
+
+        /**
+         *  The writes are buffered and coalesced by writes (see DBWriteBehind), only the last row of a
+         *  particle and the last update of the swarm are written when it flushes.
+         */
+        ostringstream particle_values;
+        particle_values << this->id
+                        << ", " << id
+                        << ", " << setprecision(10) << local_best_fitnesses[id]
+                        << ", '" << vector_to_string<double>(particles[id]) << "'"
+                        << ", '" << vector_to_string<double>(velocities[id]) << "'"
+                        << ", '" << vector_to_string<double>(local_bests[id]) << "'"
+                        << ", " << seeds[id]
+                        << ", " << version;
+
+        writes.upsert("particle", "particle_swarm_id, position, local_best_fitness, parameters, velocity, local_best, seed, version", id, particle_values.str());
 
         ostringstream swarm_query;
         swarm_query << " UPDATE particle_swarm"
@@ -533,47 +619,33 @@ ParticleSwarmDB::insert_individual(uint32_t id, const vector<double> &parameters
 //                    << ", maximum_created = " << maximum_created
                     << ", individuals_reported = " << individuals_reported
 //                    << ", maximum_reported = " << maximum_reported
+                    << ", version = " << version
                     << " WHERE "
                     << "    id = " << this->id << endl;
 
 //        cout << swarm_query.str() << endl;
 
-        mysql_query(conn, swarm_query.str().c_str());
-//        result = mysql_store_result(conn);
-
-        if (mysql_errno(conn) != 0) {
-            ostringstream ex_msg;
-            ex_msg << "ERROR: updating particle_swarm with query: '" << swarm_query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
-            throw ex_msg.str();
-        }
-//        mysql_free_result(result);
+        writes.update("particle_swarm", swarm_query.str());
 
         double best, average, median, worst;
         calculate_fitness_statistics(local_best_fitnesses, best, average, median, worst);
 
-        ostringstream log_query;
-        log_query.precision(10);
-        log_query << "INSERT INTO particle_swarm_log"
-            << " SET "
-            << "  search_id = " << this->id
-            << ", evaluation = " << this->individuals_reported
-            << ", current = '" << setprecision(10) << local_best_fitnesses[id] << "'"
-            << ", best = '" << setprecision(10) << best << "'"
-            << ", average = '" << setprecision(10) << average << "'"
-            << ", median = '" << setprecision(10) << median << "'"
-            << ", worst = '" << setprecision(10) << worst << "'"
-            << ", particle = " << id
-            << ", seed = " << seed
-            << ", global = " << setprecision(10) << (local_best_fitnesses[id] == global_best_fitness);
-
-        mysql_query(conn, log_query.str().c_str());
-
-        if (mysql_errno(conn) != 0) {
-            ostringstream ex_msg;
-            ex_msg << "ERROR: updating particle_swarm_log with query: '" << log_query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
-            throw ex_msg.str();
-        }
-
+        ostringstream log_values;
+        log_values.precision(10);
+        log_values << this->id
+            << ", " << this->individuals_reported
+            << ", '" << setprecision(10) << local_best_fitnesses[id] << "'"
+            << ", '" << setprecision(10) << best << "'"
+            << ", '" << setprecision(10) << average << "'"
+            << ", '" << setprecision(10) << median << "'"
+            << ", '" << setprecision(10) << worst << "'"
+            << ", " << id
+            << ", " << seed
+            << ", " << setprecision(10) << (local_best_fitnesses[id] == global_best_fitness);
+
+        writes.insert("particle_swarm_log", "search_id, evaluation, current, best, average, median, worst, particle, seed, global", log_values.str());
+
+        writes.result_added(conn);
     }
 
     return modified;
@@ -598,7 +670,14 @@ ParticleSwarmDB::update_current_individual() throw (string) {
         throw ex_msg.str();
     }   
     
-    for (uint32_t id = 0; id < population_size; id++) {
+    /**
+     *  Only the particles moved by new_individual since the last update need to be written
+     */
+    set<uint32_t> positions(generated_positions.begin(), generated_positions.end());
+    generated_positions.clear();
+
+    for (set<uint32_t>::iterator it = positions.begin(); it != positions.end(); it++) {
+        uint32_t id = *it;
         ostringstream particle_query;
         particle_query << "UPDATE particle"
                        << " SET "
@@ -683,6 +762,77 @@ ParticleSwarmDB::add_unfinished_searches(MYSQL *conn, int32_t app_id, vector<Evo
     mysql_free_result(result);
 }
 
+void
+ParticleSwarmDB::update_unfinished_searches(MYSQL *conn, int32_t app_id, map<string, EvolutionaryAlgorithmDB*> &unfinished_searches) throw (string) {
+    upgrade_tables(conn);
+
+    ostringstream query;
+    query << "SELECT " << SEARCH_COLUMNS << " FROM particle_swarm WHERE app_id = " << app_id
+          << " AND (maximum_reported = 0 OR individuals_reported < maximum_reported)"
+          << " AND (maximum_created = 0 OR individuals_created < maximum_created)"
+          << " AND (maximum_iterations = 0 OR current_iteration < maximum_iterations)";
+
+    mysql_query(conn, query.str().c_str());
+    MYSQL_RES *result = mysql_store_result(conn);
+
+    if (mysql_errno(conn) != 0) {
+        ostringstream ex_msg;
+        ex_msg << "ERROR: getting unfinished searches with query: '" << query.str() << "'. Error: " << mysql_errno(conn) << " -- '" << mysql_error(conn) << "'. Thrown on " << __FILE__ << ":" << __LINE__;
+        throw ex_msg.str();
+    }   
+
+    set<string> current_names;
+    MYSQL_ROW search_row;
+
+    while ((search_row = mysql_fetch_row(result))) {
+        string search_name = search_row[1];
+        current_names.insert(search_name);
+
+        ParticleSwarmDB *search = NULL;
+        map<string, EvolutionaryAlgorithmDB*>::iterator it = unfinished_searches.find(search_name);
+        if (it != unfinished_searches.end()) search = dynamic_cast<ParticleSwarmDB*>(it->second);
+
+        /**
+         *  A search that was recreated, or whose population or bounds were changed, is read in full again
+         */
+        vector<double> row_min_bound, row_max_bound;
+        string_to_vector<double>(search_row[15], row_min_bound);
+        string_to_vector<double>(search_row[16], row_max_bound);
+
+        if (search != NULL && (search->id != (uint32_t)atoi(search_row[0])
+                    || search->population_size != (uint32_t)atoi(search_row[14])
+                    || search->min_bound != row_min_bound
+                    || search->max_bound != row_max_bound
+                    || search->version > (uint32_t)atoi(search_row[19]))) {
+            delete search;
+            unfinished_searches.erase(it);
+            search = NULL;
+        }
+
+        if (search == NULL) {
+            unfinished_searches[search_name] = new ParticleSwarmDB(conn, search_row);
+        } else {
+            search->refresh_from_database(search_row);
+        }
+    }   
+    mysql_free_result(result);
+
+    /**
+     *  Remove the particle swarms that finished or were deleted
+     */
+    map<string, EvolutionaryAlgorithmDB*>::iterator it = unfinished_searches.begin();
+    while (it != unfinished_searches.end()) {
+        ParticleSwarmDB *search = dynamic_cast<ParticleSwarmDB*>(it->second);
+
+        if (search != NULL && (current_names.count(it->first) == 0 || !search->is_running())) {
+            delete search;
+            unfinished_searches.erase(it++);
+        } else {
+            it++;
+        }
+    }
+}
+
 void
 ParticleSwarmDB::print_to(ostream& stream) {
     stream  << "[ParticleSwarmDB " << endl
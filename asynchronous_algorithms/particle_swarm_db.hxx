@@ -21,6 +21,7 @@
 #define TAO_PARTICLE_SWARM_DB
 
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <string>
 #include <vector>
@@ -37,11 +38,15 @@ class ParticleSwarmDB : public ParticleSwarm, public EvolutionaryAlgorithmDB {
 
         MYSQL *conn;
 
+        //positions of the individuals generated since the last update_current_individual
+        std::vector<uint32_t> generated_positions;
+
         void check_name(std::string name) throw (std::string);
 
     public:
         ParticleSwarmDB(MYSQL *conn, std::string name) throw (std::string);
         ParticleSwarmDB(MYSQL *conn, int id) throw (std::string);
+        ParticleSwarmDB(MYSQL *conn, MYSQL_ROW row) throw (std::string);
 
         ParticleSwarmDB( MYSQL *conn,
                          const std::vector<std::string> &arguments) throw (std::string);
@@ -121,10 +126,16 @@ class ParticleSwarmDB : public ParticleSwarm, public EvolutionaryAlgorithmDB {
         static bool search_exists(MYSQL *conn, std::string search_name) throw (std::string);
         static void create_tables(MYSQL *conn) throw (std::string);
 
+        //adds the columns added since an older version of TAO created the tables, once per process
+        static void upgrade_tables(MYSQL *conn) throw (std::string);
+
         void construct_from_database(std::string query) throw (std::string);
         void construct_from_database(MYSQL_ROW row) throw (std::string);
         void insert_to_database() throw (std::string);           /* Insert a particle swarm into the database */
 
+        //updates the search from its row, reading back only the individuals changed since it was last read
+        void refresh_from_database(MYSQL_ROW row) throw (std::string);
+
         /**
          *  The following methods are used for asynchronous optimization
          */
@@ -134,9 +145,19 @@ class ParticleSwarmDB : public ParticleSwarm, public EvolutionaryAlgorithmDB {
 
         virtual void update_current_individual() throw (std::string);
 
+        virtual uint32_t get_individuals_reported()     { return ParticleSwarm::get_individuals_reported(); }
+        virtual uint32_t get_remaining_individuals()    { return ParticleSwarm::get_remaining_individuals(); }
+
         static void add_searches(MYSQL *conn, int32_t app_id, std::vector<EvolutionaryAlgorithmDB*> &searches) throw (std::string);
         static void add_unfinished_searches(MYSQL *conn, int32_t app_id, std::vector<EvolutionaryAlgorithmDB*> &unfinished_searches) throw (std::string);
 
+        /**
+         *  Brings the searches of this type kept in memory up to date with the unfinished searches in the database:
+         *  new searches (or ones whose definition changed) are read in full, finished or removed ones are deleted,
+         *  and the rest are refreshed with refresh_from_database.
+         */
+        static void update_unfinished_searches(MYSQL *conn, int32_t app_id, std::map<std::string, EvolutionaryAlgorithmDB*> &unfinished_searches) throw (std::string);
+
         void print_to(std::ostream& stream);
         friend std::ostream& operator<< (std::ostream& stream, ParticleSwarmDB &ps);
 };
@@ -26,6 +26,7 @@
 
 #include "boinc_db.h"
 #include "error_numbers.h"
+#include "util.h"
 
 #include "credit.h"
 #include "sched_config.h"
@@ -47,6 +48,20 @@
 
 #define FITNESS_ERROR_BOUND 10e-8
 
+/**
+ *  By default the searches' writes for each result are made before its workunit is validated. Batching can
+ *  be turned on in the <config> section of the project's config.xml, e.g.:
+ *      <tao_write_behind_results>100</tao_write_behind_results>    (1 writes every result through, the default)
+ *      <tao_write_behind_seconds>10</tao_write_behind_seconds>     (0 only writes by count, the default)
+ *
+ *  The writes are then buffered and written together once write_behind_results are pending, or once the
+ *  oldest pending one has waited write_behind_seconds (checked as each workunit is validated). They are also
+ *  written when the validator exits normally, but not if it is killed or crashes: a result still buffered
+ *  then is lost to the search (the workunit is already validated).
+ */
+uint32_t write_behind_results = 1;
+uint32_t write_behind_seconds = 0;
+
 
 map<string, EvolutionaryAlgorithm*> searches;
 
@@ -56,6 +71,39 @@ using boost::uniform_real;
 
 variate_generator< mt11213b, uniform_real<> > random_number_generator(mt11213b( time(0) ), uniform_real<>(0.0, 1.0));
 
+void read_write_behind_limits() {
+    char *config_xml;
+    if (read_file_malloc(config.project_path("config.xml"), config_xml)) {
+        log_messages.printf(MSG_CRITICAL, "Could not read config.xml for the write behind limits, using the defaults.\n");
+    } else {
+        string xml(config_xml);
+        free(config_xml);
+
+        try {
+            write_behind_results = parse_xml<int>(xml, "tao_write_behind_results");
+        } catch (string error_message) {
+            //not set, use the default
+        }
+
+        try {
+            write_behind_seconds = parse_xml<int>(xml, "tao_write_behind_seconds");
+        } catch (string error_message) {
+            //not set, use the default
+        }
+    }
+
+    log_messages.printf(MSG_NORMAL, "Writing results to the searches after %u results or %u seconds.\n", write_behind_results, write_behind_seconds);
+}
+
+//write out the buffered results when the validator is stopped
+void flush_searches() {
+    try {
+        DBWriteBehind::flush_all();
+    } catch (string err_msg) {
+        log_messages.printf(MSG_CRITICAL, "Error writing buffered results on exit: %s\n", err_msg.c_str());
+    }
+}
+
 /*
  * Given a set of results, check for a canonical result,
  * i.e. a set of at least min_quorum/2+1 results for which
@@ -71,6 +119,21 @@ variate_generator< mt11213b, uniform_real<> > random_number_generator(mt11213b(
 int check_set(vector<RESULT>& results, WORKUNIT& wu, int& canonicalid, double&, bool& retry) {
     retry = false;
 
+    static bool started = false;
+    if (!started) {
+        read_write_behind_limits();
+        atexit(flush_searches);
+        started = true;
+    }
+
+    //searches that have stopped getting results still need their buffered results written
+    try {
+        DBWriteBehind::flush_expired();
+    } catch (string error_message) {
+        log_messages.printf(MSG_CRITICAL, "ea_validation_policy check_set([WORKUNIT#%d %s]) failed writing buffered results: %s\n", wu.id, wu.name, error_message.c_str());
+        exit(1);
+    }
+
     /**
      *  Parse all the fitnesses from the results
      */
@@ -153,10 +216,14 @@ int check_set(vector<RESULT>& results, WORKUNIT& wu, int& canonicalid, double&,
             log_messages.printf(MSG_DEBUG, "search '%s' not found, looking up in database.\n", search_name.c_str());
 
             if (search_name.substr(0,3).compare("ps_") == 0) {
-                ea = new ParticleSwarmDB(boinc_db.mysql, search_id);
+                ParticleSwarmDB *ps = new ParticleSwarmDB(boinc_db.mysql, search_id);
+                ps->set_write_behind(write_behind_results, write_behind_seconds);
+                ea = ps;
                 searches[search_name] = ea;
             } else if (search_name.substr(0,3).compare("de_") == 0) {
-                ea = new DifferentialEvolutionDB(boinc_db.mysql, search_id);
+                DifferentialEvolutionDB *de = new DifferentialEvolutionDB(boinc_db.mysql, search_id);
+                de->set_write_behind(write_behind_results, write_behind_seconds);
+                ea = de;
                 searches[search_name] = ea;
             } else {
                 log_messages.printf(MSG_CRITICAL, "ea_validation_policy check_set([WORKUNIT#%d %s]) had an unkown search name (either removed from database or needs to start with de_ or ps_): '%s'\n", wu.id, wu.name, search_name.c_str());
@@ -28,6 +28,8 @@
 #include <sstream>
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <cmath>
 
 #include "boinc_db.h"
 #include "error_numbers.h"
@@ -57,8 +59,12 @@
 #endif
 
 
-#define CUSHION 500 // maintain at least this many unsent results
+#define CUSHION 500 // maintain at least this many unsent results until the rate they are sent out has been measured
 #define REPLICATION_FACTOR  1
+#define RATE_WEIGHT 0.3     // weight of the newest measurement in the averaged rates results are sent out and returned
+#define RATE_BLEND 0.5      // how much of a search's share of the jobs follows the results it returns per job, the rest is by priority alone
+#define POLL_FRACTION 0.25  // poll again after about this fraction of the unsent results should have been sent out
+#define BATCH_QUERY_SIZE 1000000    // insert the workunit rows in queries of about this many bytes, well under max_allowed_packet
 
 using std::ostringstream;
 using std::vector;
@@ -73,18 +79,184 @@ bool requires_seeding = false;
 
 map<string, char*> in_templates;
 
-// create one new job
+double lead_time = 300;     // seconds of sending out results the cushion should cover
+int min_cushion = 100;
+int max_cushion = 50000;
+int min_poll = 10;          // seconds, also gives the transitioner time to create the results of new jobs
+int max_poll = 60;
+
+/**
+ *  Sizes the cushion of unsent results from the rate they are being sent out, so there is enough queued to
+ *  cover lead_time seconds of it: the queue does not drain during surges of volunteers, and work is not made
+ *  long before it will be sent when things are quiet (for an asynchronous search, work made later is made
+ *  from better individuals). The poll interval shrinks as the queue drains faster.
+ */
+class CushionController {
+    private:
+        double rate;            // results sent out per second, exponentially weighted
+        bool measured;
+        int last_poll;          // unix time (seconds) of the last poll
+        int expected_unsent;    // unsent results at the last poll, plus the results of the jobs made since
+
+    public:
+        CushionController() : rate(0), measured(false), last_poll(0), expected_unsent(0) {
+        }
+
+        int get_last_poll() {
+            return last_poll;
+        }
+
+        /**
+         *  Called at each poll (at unix time now) with the number of unsent results, and the number of results
+         *  sent out since the last poll (with a sent_time from last_poll up to, but not including, now).
+         */
+        void update(int now, int unsent, int sent) {
+            if (last_poll > 0 && now > last_poll) {
+                double current_rate = (double)sent / (now - last_poll);
+                if (measured) rate = (RATE_WEIGHT * current_rate) + ((1.0 - RATE_WEIGHT) * rate);
+                else rate = current_rate;
+                measured = true;
+            }
+
+            last_poll = now;
+            expected_unsent = unsent;
+        }
+
+        void created(int njobs) {
+            expected_unsent += njobs * REPLICATION_FACTOR;
+        }
+
+        double get_rate() {
+            return rate;
+        }
+
+        int get_cushion() {
+            if (!measured) return CUSHION;
+
+            int cushion = rate * lead_time;
+            if (cushion < min_cushion) return min_cushion;
+            if (cushion > max_cushion) return max_cushion;
+            return cushion;
+        }
+
+        int get_poll_interval() {
+            if (rate <= 0) return max_poll;
+
+            double interval = POLL_FRACTION * expected_unsent / rate;
+            if (interval < min_poll) return min_poll;
+            if (interval > max_poll) return max_poll;
+            return interval;
+        }
+};
+
+/**
+ *  The unfinished searches are kept in memory between cycles, each cycle only reads back what the validator
+ *  changed since the last one.
+ */
+map<string, EvolutionaryAlgorithmDB*> searches;
+
+/**
+ *  The rate each search's results are being returned, as individuals reported per job made for it. This is
+ *  relative to the jobs it was given, so a search given more jobs than the others (which then returns more
+ *  results) is not given more again because of it.
+ */
+struct ReturnRate {
+    bool started;
+    uint32_t individuals_reported;      // when the rate was last measured
+    uint32_t jobs_made;                 // for the search since the rate was last measured
+    double rate;
+    bool measured;
+
+    ReturnRate() : started(false), individuals_reported(0), jobs_made(0), rate(0), measured(false) {
+    }
+};
+
+map<string, ReturnRate> return_rates;
+
+/**
+ *  Splits number_jobs between the searches in proportion to their weights, without giving any search more than it
+ *  needs (what a search does not need goes to the others). The jobs left over from rounding go to the searches
+ *  with the largest fractional shares.
+ */
+void allocate_jobs(uint32_t number_jobs, const vector<double> &weights, const vector<uint32_t> &needs, vector<uint32_t> &allocation) {
+    allocation.assign(weights.size(), 0);
+
+    vector<bool> open(weights.size());
+    for (uint32_t i = 0; i < weights.size(); i++) open[i] = weights[i] > 0 && needs[i] > 0;
+
+    uint32_t remaining = number_jobs;
+    while (remaining > 0) {
+        double total_weight = 0;
+        for (uint32_t i = 0; i < weights.size(); i++) {
+            if (open[i]) total_weight += weights[i];
+        }
+        if (total_weight <= 0) break;
+
+        //searches whose share covers what they need get exactly that, and the rest is split again
+        vector<uint32_t> capped;
+        for (uint32_t i = 0; i < weights.size(); i++) {
+            if (open[i] && ((double)remaining * weights[i] / total_weight) >= needs[i]) capped.push_back(i);
+        }
+
+        if (capped.size() > 0) {
+            for (uint32_t j = 0; j < capped.size(); j++) {
+                allocation[capped[j]] = needs[capped[j]];
+                remaining -= needs[capped[j]];
+                open[capped[j]] = false;
+            }
+            continue;
+        }
+
+        vector< pair<double, uint32_t> > fractions;
+        uint32_t given = 0;
+        for (uint32_t i = 0; i < weights.size(); i++) {
+            if (!open[i]) continue;
+
+            double share = (double)remaining * weights[i] / total_weight;
+            uint32_t whole = floor(share);
+            allocation[i] = whole;
+            given += whole;
+            fractions.push_back(make_pair(share - whole, i));
+        }
+
+        sort(fractions.rbegin(), fractions.rend());
+        for (uint32_t j = 0; j < remaining - given && j < fractions.size(); j++) {
+            allocation[fractions[j].second]++;
+        }
+        break;
+    }
+}
+
+/**
+ *  The workunit information of a search never changes, so it is only read from the database the
+ *  first time the search needs jobs.
+ */
+map<string, WorkunitInformation*> workunit_informations;
+
+WorkunitInformation* get_workunit_information(const string &search_name) throw (string) {
+    map<string, WorkunitInformation*>::iterator it = workunit_informations.find(search_name);
+    if (it != workunit_informations.end()) return it->second;
+
+    WorkunitInformation *workunit_information = new WorkunitInformation(boinc_db.mysql, search_name);
+    workunit_informations[search_name] = workunit_information;
+    return workunit_information;
+}
+
+// create the workunit row for one new job, its values are appended to
+// values to be inserted with the other jobs by insert_jobs
 //
-int make_job(string search_name,
-             string workunit_xml_filename,
-             string result_xml_filename,
-             vector<string> input_filenames,
-             string command_line_options,
-             string extra_xml,
-             uint32_t search_id) {
+int make_job(const string &search_name,
+             const string &workunit_xml_filename,
+             const string &result_xml_filename,
+             const vector<string> &input_filenames,
+             const string &command_line_options,
+             const string &extra_xml,
+             uint32_t search_id,
+             string &values) {
 
     DB_WORKUNIT wu;
     char name[256], path[MAXPATHLEN];
+    static char value_buffer[MAX_QUERY_LEN];
 
     // make a unique name (for the job and its input file)
     sprintf(name, "%s_%d_%d", search_name.c_str(), start_time, seqno++);
@@ -139,9 +311,9 @@ int make_job(string search_name,
 //    cout << "extra_xml: " << extra_xml << endl;
 //    cout << "command_line_options: " << command_line_options << endl;
 
-    // Register the job with BOINC
+    // Fill in the job's row, the job is registered with BOINC when the rows are inserted
     sprintf(path, "templates/%s", result_xml_filename.c_str());
-    return create_work(
+    int retval = create_work(
         wu,
         in_template,
         path,
@@ -150,8 +322,30 @@ int make_job(string search_name,
         input_filenames.size(),
         config,
         command_line_options.c_str(),
-        extra_xml.c_str()
+        extra_xml.c_str(),
+        value_buffer
     );
+    if (retval) return retval;
+
+    if (!values.empty()) values += ",";
+    values += value_buffer;
+    return 0;
+}
+
+// insert the workunit rows made by make_job with a single multi-row query
+//
+int insert_jobs(string &values) {
+    if (values.empty()) return 0;
+
+    DB_WORKUNIT wu;
+    int retval = wu.insert_batch(values);
+    if (retval) {
+        log_messages.printf(MSG_CRITICAL, "ERROR: inserting workunits failed: %s\n", boincerror(retval));
+        return retval;
+    }
+
+    values.clear();
+    return 0;
 }
 
 /**
@@ -160,76 +354,175 @@ int make_job(string search_name,
  *
  *  For each unfinished search:
  *      Get workunit information for search
- *      generate equal portion of workunits
+ *      generate its share of the workunits, weighted by priority and return rate
  */
-int make_jobs(uint32_t number_jobs) {
+int make_jobs(uint32_t number_jobs, uint32_t &jobs_made) {
     int retval;
+    jobs_made = 0;
 
-    vector<EvolutionaryAlgorithmDB*> unfinished_searches;
     try {
-        log_messages.printf(MSG_DEBUG, "getting unfinished particle swarms\n");
-        ParticleSwarmDB::add_unfinished_searches(boinc_db.mysql, app.id, unfinished_searches);
-        log_messages.printf(MSG_DEBUG, "getting unfinished differential_evolutions\n");
-        DifferentialEvolutionDB::add_unfinished_searches(boinc_db.mysql, app.id, unfinished_searches);
+        log_messages.printf(MSG_DEBUG, "updating unfinished particle swarms\n");
+        ParticleSwarmDB::update_unfinished_searches(boinc_db.mysql, app.id, searches);
+        log_messages.printf(MSG_DEBUG, "updating unfinished differential_evolutions\n");
+        DifferentialEvolutionDB::update_unfinished_searches(boinc_db.mysql, app.id, searches);
     } catch (string err_msg) {
         log_messages.printf(MSG_CRITICAL, "Error thrown getting unfinished searches:\n    '%s'\n", err_msg.c_str());
         exit(1);
     }
 
+    //forget the workunit information of searches that finished or were removed, they may be recreated with the same name
+    map<string, WorkunitInformation*>::iterator wi = workunit_informations.begin();
+    while (wi != workunit_informations.end()) {
+        if (searches.count(wi->first) == 0) {
+            delete wi->second;
+            workunit_informations.erase(wi++);
+        } else {
+            wi++;
+        }
+    }
+
+    map<string, ReturnRate>::iterator rr = return_rates.begin();
+    while (rr != return_rates.end()) {
+        if (searches.count(rr->first) == 0) return_rates.erase(rr++);
+        else rr++;
+    }
+
+    vector<EvolutionaryAlgorithmDB*> unfinished_searches;
+    for (map<string, EvolutionaryAlgorithmDB*>::iterator it = searches.begin(); it != searches.end(); it++) {
+        unfinished_searches.push_back(it->second);
+    }
+
     log_messages.printf(MSG_DEBUG, "got %lu unfinished searches\n", unfinished_searches.size());
     log_messages.printf(MSG_DEBUG, "number jobs: %u\n", number_jobs);
 
     if (unfinished_searches.size() == 0) return 0;
-    uint64_t portion = (uint64_t)number_jobs / unfinished_searches.size();
+
+    /**
+     *  Update the rate each search's results are being returned
+     */
+    double total_rate = 0;
+    uint32_t number_measured = 0;
+    for (uint32_t i = 0; i < unfinished_searches.size(); i++) {
+        ReturnRate &return_rate = return_rates[unfinished_searches[i]->get_name()];
+        uint32_t individuals_reported = unfinished_searches[i]->get_individuals_reported();
+
+        if (!return_rate.started) {
+            return_rate.individuals_reported = individuals_reported;
+            return_rate.started = true;
+
+        } else if (return_rate.jobs_made > 0) {
+            //a search not given any jobs since the last measurement is measured once it is, over both intervals
+            double reported = individuals_reported > return_rate.individuals_reported ? individuals_reported - return_rate.individuals_reported : 0;
+            double current_rate = reported / return_rate.jobs_made;
+
+            if (return_rate.measured) return_rate.rate = (RATE_WEIGHT * current_rate) + ((1.0 - RATE_WEIGHT) * return_rate.rate);
+            else return_rate.rate = current_rate;
+            return_rate.measured = true;
+
+            return_rate.individuals_reported = individuals_reported;
+            return_rate.jobs_made = 0;
+        }
+
+        if (return_rate.measured) {
+            total_rate += return_rate.rate;
+            number_measured++;
+        }
+    }
+    double mean_rate = number_measured > 0 ? total_rate / number_measured : 0;
+
+    /**
+     *  Weight each search by its priority, scaled by the results it returns per job compared to the
+     *  others, and give each no more jobs than it needs to finish.
+     */
+    vector<double> weights(unfinished_searches.size());
+    vector<uint32_t> needs(unfinished_searches.size());
+    for (uint32_t i = 0; i < unfinished_searches.size(); i++) {
+        const ReturnRate &return_rate = return_rates[unfinished_searches[i]->get_name()];
+
+        double relative_rate = 1.0;
+        if (return_rate.measured && mean_rate > 0) relative_rate = return_rate.rate / mean_rate;
+
+        weights[i] = unfinished_searches[i]->get_priority() * ((1.0 - RATE_BLEND) + (RATE_BLEND * relative_rate));
+        needs[i] = unfinished_searches[i]->get_remaining_individuals();
+    }
+
+    vector<uint32_t> allocation;
+    allocate_jobs(number_jobs, weights, needs, allocation);
+
+    uint32_t max_allocation = *max_element(allocation.begin(), allocation.end());
 
     log_messages.printf(MSG_DEBUG, "Generating %u total jobs for %lu unfinished searches.\n", number_jobs, unfinished_searches.size());
 
     /**
-     *  For each unfinished search generate equal portion of workunits
+     *  For each unfinished search generate its share of the workunits. The rows for all of them are
+     *  built in memory and inserted in large multi-row queries within one transaction, instead of a
+     *  separate insert for every job.
      */
+    string values;
+    values.reserve(2 * BATCH_QUERY_SIZE);
+
+    vector<uint32_t> ids(max_allocation), seeds(max_allocation);
+    vector< vector<double> > individuals(max_allocation);
+
+    ostringstream new_command_line, new_extra_xml;
+    new_command_line.precision(15);
+
+    boinc_db.start_transaction();
+
     for (uint32_t i = 0; i < unfinished_searches.size(); i++) {
-        log_messages.printf(MSG_DEBUG, "    Generating %lu jobs for unfinished search '%s'.\n", portion, unfinished_searches[i]->get_name().c_str());
+        uint32_t portion = allocation[i];
+        if (portion == 0) continue;
+
+        log_messages.printf(MSG_DEBUG, "    Generating %u jobs for unfinished search '%s' (priority %lf, returning %lf results per job).\n", portion, unfinished_searches[i]->get_name().c_str(), unfinished_searches[i]->get_priority(), return_rates[unfinished_searches[i]->get_name()].rate);
 
         /**
          *  Get the standard workunit information for this search
          */
-        WorkunitInformation workunit_information(boinc_db.mysql, unfinished_searches[i]->get_name());       //TODO: should cache this since it never changes
-//        cout << "info: " << workunit_information << endl;
+        WorkunitInformation *workunit_information;
+        try {
+            workunit_information = get_workunit_information(unfinished_searches[i]->get_name());
+        } catch (string err_msg) {
+            log_messages.printf(MSG_CRITICAL, "ERROR: getting workunit information for search '%s' threw error message: '%s'.\n", unfinished_searches[i]->get_name().c_str(), err_msg.c_str());
+            exit(1);
+        }
+//        cout << "info: " << *workunit_information << endl;
+
+        const string &command_line_options = workunit_information->get_command_line_options();
+        const string &extra_xml = workunit_information->get_extra_xml();
+
+        try {
+            for (uint32_t j = 0; j < portion; j++) {
+                if (requires_seeding) unfinished_searches[i]->new_individual(ids[j], individuals[j], seeds[j]);
+                else unfinished_searches[i]->new_individual(ids[j], individuals[j]);
+            }
+        } catch (string err_msg) {
+            log_messages.printf(MSG_CRITICAL, "ERROR: creating new individual for search '%s' threw error message: '%s'.\n", unfinished_searches[i]->get_name().c_str(), err_msg.c_str());
+            exit(1);
+        }
 
         for (uint32_t j = 0; j < portion; j++) {
 //            log_messages.printf(MSG_DEBUG, "        JOB %u\n", j);
-            uint32_t id;
-            uint32_t seed;
-
-            vector<double> parameters;
-            try {
-                if (requires_seeding) unfinished_searches[i]->new_individual(id, parameters, seed);
-                else unfinished_searches[i]->new_individual(id, parameters);
-            } catch (string err_msg) {
-                log_messages.printf(MSG_CRITICAL, "ERROR: creating new individual for search '%s' threw error message: '%s'.\n", unfinished_searches[i]->get_name().c_str(), err_msg.c_str());
-                exit(1);
-            }
+            const vector<double> &parameters = individuals[j];
 
-            ostringstream new_command_line;
-            new_command_line << workunit_information.get_command_line_options();
-            if (requires_seeding) new_command_line << " --seed " << seed;
+            new_command_line.str("");
+            new_command_line << command_line_options;
+            if (requires_seeding) new_command_line << " --seed " << seeds[j];
             new_command_line << " -np " << parameters.size() << " -p";
-            new_command_line.precision(15);
             for (uint32_t k = 0; k < parameters.size(); k++) new_command_line << " " << parameters[k];
 
-            ostringstream new_extra_xml;
-            new_extra_xml << workunit_information.get_extra_xml() << endl;
+            new_extra_xml.str("");
+            new_extra_xml << extra_xml << endl;
 #ifdef FPOPS_FROM_PARAMETERS
             double rsc_fpops_est, rsc_fpops_bound;
-            calculate_fpops(parameters, rsc_fpops_est, rsc_fpops_bound, workunit_information.get_extra_xml());
+            calculate_fpops(parameters, rsc_fpops_est, rsc_fpops_bound, extra_xml);
             new_extra_xml << "<rsc_fpops_est>"   << rsc_fpops_est   << "</rsc_fpops_est>"   << endl;
             new_extra_xml << "<rsc_fpops_bound>" << rsc_fpops_bound << "</rsc_fpops_bound>" << endl;
 #endif
             new_extra_xml << "<search_name>" << unfinished_searches[i]->get_name() << "</search_name>" << endl;
             new_extra_xml << "<search_id>" << unfinished_searches[i]->get_id() << "</search_id>" << endl;
-            new_extra_xml << "<position>" << id << "</position>" << endl;
+            new_extra_xml << "<position>" << ids[j] << "</position>" << endl;
             new_extra_xml << "<parameters>" << vector_to_string(parameters) << "</parameters>" << endl;
-            if (requires_seeding) new_extra_xml << "<seed>" << seed << "</seed>" << endl;
+            if (requires_seeding) new_extra_xml << "<seed>" << seeds[j] << "</seed>" << endl;
 
 //            cerr << "new_extra_xml: " << endl;
 //            cerr << new_extra_xml.str() << endl;
@@ -238,17 +531,39 @@ int make_jobs(uint32_t number_jobs) {
              *  Generate the job with the updated workunit information
              */
             retval = make_job(unfinished_searches[i]->get_name(),
-                              workunit_information.get_workunit_xml_filename(),
-                              workunit_information.get_result_xml_filename(),
-                              workunit_information.get_input_filenames(),
+                              workunit_information->get_workunit_xml_filename(),
+                              workunit_information->get_result_xml_filename(),
+                              workunit_information->get_input_filenames(),
                               new_command_line.str(),
                               new_extra_xml.str(),
-                              unfinished_searches[i]->get_id()
+                              unfinished_searches[i]->get_id(),
+                              values
                              );
 
-            if (retval) return retval;
+            if (!retval && values.size() >= BATCH_QUERY_SIZE) retval = insert_jobs(values);
+
+            if (retval) {
+                boinc_db.rollback_transaction();
+                return retval;
+            }
         }
+    }
 
+    retval = insert_jobs(values);
+    if (retval) {
+        boinc_db.rollback_transaction();
+        return retval;
+    }
+    boinc_db.commit_transaction();
+    for (uint32_t i = 0; i < allocation.size(); i++) {
+        jobs_made += allocation[i];
+        return_rates[unfinished_searches[i]->get_name()].jobs_made += allocation[i];
+    }
+
+    /**
+     *  The searches only record the individuals they have handed out once the jobs for them exist.
+     */
+    for (uint32_t i = 0; i < unfinished_searches.size(); i++) {
         try {
             unfinished_searches[i]->update_current_individual();
         } catch (string err_msg) {
@@ -257,18 +572,25 @@ int make_jobs(uint32_t number_jobs) {
         }
     }
 
-    EvolutionaryAlgorithmDB *eadb;
-    while (unfinished_searches.size() > 0) {
-        eadb = unfinished_searches.back();
-        unfinished_searches.pop_back();
-        delete eadb;
-    }
-
     return 0;
 }
 
+/**
+ *  Counts the results of the application that were sent out from since up to, but not including, until (unix times).
+ *  The dispatch rate is measured from these rather than from the drop in unsent results, which also falls behind
+ *  while the transitioner has not yet created the results of new jobs.
+ */
+int count_sent_results(int &n, int appid, int since, int until) {
+    DB_RESULT result;
+    char clause[256];
+
+    sprintf(clause, "where appid=%d and sent_time>=%d and sent_time<%d", appid, since, until);
+    return result.count(n, clause);
+}
+
 void main_loop() {
     int retval;
+    CushionController controller;
 
     while (1) {
         check_stop_daemons();
@@ -281,23 +603,40 @@ void main_loop() {
             exit(retval);
         }
 
-        if (n > CUSHION) {
-            sleep(30);
-        } else {
-            int njobs = (CUSHION - n)/REPLICATION_FACTOR;
+        int now = time(0);
+        int sent = 0;
+        if (controller.get_last_poll() > 0) {
+            retval = count_sent_results(sent, app.id, controller.get_last_poll(), now);
+
+            if (retval) {
+                log_messages.printf(MSG_CRITICAL,"count_sent_results() failed: %s\n", boincerror(retval));
+                exit(retval);
+            }
+        }
+
+        controller.update(now, n, sent);
+        int cushion = controller.get_cushion();
+        log_messages.printf(MSG_DEBUG, "%d unsent results, sending %lf per second, cushion %d\n", n, controller.get_rate(), cushion);
+
+        if (n <= cushion) {
+            int njobs = (cushion - n)/REPLICATION_FACTOR;
             log_messages.printf(MSG_DEBUG, "Making %d jobs\n", njobs);
 
-            retval = make_jobs(njobs);
+            uint32_t jobs_made;
+            retval = make_jobs(njobs, jobs_made);
             if (retval) {
                 log_messages.printf(MSG_CRITICAL, "failed making jobs with error: %s\n", boincerror(retval));
                 exit(retval);
             }
-
-            // Now sleep for a few seconds to let the transitioner
-            // create instances for the jobs we just created.
-            // Otherwise we could end up creating an excess of jobs.
-            sleep(30);
+            controller.created(jobs_made);
         }
+
+        // The poll interval is at least min_poll seconds to let the
+        // transitioner create instances for the jobs we just created.
+        // Otherwise we could end up creating an excess of jobs.
+        int poll_interval = controller.get_poll_interval();
+        log_messages.printf(MSG_DEBUG, "Polling again in %d seconds\n", poll_interval);
+        sleep(poll_interval);
     }
 }
 
@@ -305,7 +644,8 @@ void usage(char *name) {
     fprintf(stderr, "This is an example BOINC work generator.\n"
         "This work generator has the following properties\n"
         "(you may need to change some or all of these):\n"
-        "  It attempts to maintain a \"cushion\" of 100 unsent job instances.\n"
+        "  It attempts to maintain a \"cushion\" of unsent job instances large enough to cover\n"
+        "  --lead_time seconds of sending them out, at the rate they are being sent.\n"
         "  (your app may not work this way; e.g. you might create work in batches)\n"
         "- Creates work for the application \"example_app\".\n"
         "- Creates a new input file for each job;\n"
@@ -317,7 +657,12 @@ void usage(char *name) {
         "  [ -d X ]                 Sets debug level to X.\n"
         "  [ -h | --help ]          Shows this help text.\n"
         "  [ -v | --version ]       Shows version information.\n"
-        "  [ -c | --create-table ]  Create the database table 'tao_workunit_information' used to store workunit information.\n",
+        "  [ -c | --create-table ]  Create the database table 'tao_workunit_information' used to store workunit information.\n"
+        "  [ --lead_time X ]        Seconds of sending out results the cushion of unsent results should cover (default: 300).\n"
+        "  [ --min_cushion X ]      Minimum number of unsent results (default: 100).\n"
+        "  [ --max_cushion X ]      Maximum number of unsent results (default: 50000).\n"
+        "  [ --min_poll X ]         Minimum seconds between checking the number of unsent results (default: 10).\n"
+        "  [ --max_poll X ]         Maximum seconds between checking the number of unsent results (default: 60).\n",
         name
     );
 }
@@ -349,6 +694,16 @@ int main(int argc, char** argv) {
             create_table = true;
         } else if (is_arg(argv[i], "s") || is_arg(argv[i], "requires_seeding")) {
             requires_seeding = true;
+        } else if (!strcmp(argv[i], "--lead_time")) {
+            lead_time = atof(argv[++i]);
+        } else if (!strcmp(argv[i], "--min_cushion")) {
+            min_cushion = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--max_cushion")) {
+            max_cushion = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--min_poll")) {
+            min_poll = atoi(argv[++i]);
+        } else if (!strcmp(argv[i], "--max_poll")) {
+            max_poll = atoi(argv[++i]);
         } else {
             log_messages.printf(MSG_CRITICAL, "unknown command line argument: %s\n\n", argv[i]);
             usage(argv[0]);
@@ -40,11 +40,11 @@ class WorkunitInformation {
         string extra_xml;
 
     public:
-        string          get_workunit_xml_filename()     { return workunit_xml_filename; }
-        string          get_result_xml_filename()       { return result_xml_filename; }
-        vector<string>  get_input_filenames()           { return input_filenames; }
-        string          get_command_line_options()      { return command_line_options; }
-        string          get_extra_xml()                 { return extra_xml; }
+        const string&           get_workunit_xml_filename() const   { return workunit_xml_filename; }
+        const string&           get_result_xml_filename() const     { return result_xml_filename; }
+        const vector<string>&   get_input_filenames() const         { return input_filenames; }
+        const string&           get_command_line_options() const    { return command_line_options; }
+        const string&           get_extra_xml() const               { return extra_xml; }
 
         WorkunitInformation(MYSQL *conn,
                             const string search_name 
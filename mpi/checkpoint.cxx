@@ -0,0 +1,152 @@
+#include <cstdio>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "mpi/checkpoint.hxx"
+
+using namespace std;
+
+static const char CHECKPOINT_MAGIC[8] = {'T', 'A', 'O', 'C', 'K', 'P', 'T', '1'};
+
+Checkpoint::Checkpoint() : read_position(0) {
+}
+
+void Checkpoint::clear() {
+    buffer.clear();
+    read_position = 0;
+}
+
+void Checkpoint::swap(Checkpoint &other) {
+    buffer.swap(other.buffer);
+    std::swap(read_position, other.read_position);
+}
+
+void Checkpoint::read_bytes(void *destination, size_t size) throw (string) {
+    if (size > buffer.size() - read_position) throw string("checkpoint is truncated.");
+
+    memcpy(destination, &buffer[read_position], size);
+    read_position += size;
+}
+
+void Checkpoint::write_string(const string &value) {
+    write((uint64_t)value.size());
+    buffer.insert(buffer.end(), value.begin(), value.end());
+}
+
+void Checkpoint::read_string(string &value) throw (string) {
+    uint64_t size;
+    read(size);
+    if (size > buffer.size() - read_position) throw string("checkpoint is truncated.");
+
+    value.assign(&buffer[read_position], size);
+    read_position += size;
+}
+
+void Checkpoint::write_generator(const mt19937 &generator) {
+    ostringstream state;
+    state << generator;
+    write_string(state.str());
+}
+
+void Checkpoint::read_generator(mt19937 &generator) throw (string) {
+    string state;
+    read_string(state);
+
+    istringstream state_stream(state);
+    state_stream >> generator;
+    if (state_stream.fail()) throw string("checkpoint has an invalid random number generator state.");
+}
+
+void Checkpoint::save(const string &filename, const string &tag) const throw (string) {
+    string temporary_filename = filename + ".tmp";
+
+    FILE *file = fopen(temporary_filename.c_str(), "wb");
+    if (file == NULL) throw string("could not open '" + temporary_filename + "' for writing.");
+
+    uint64_t tag_size = tag.size();
+    uint64_t size = buffer.size();
+
+    bool written = fwrite(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC), 1, file) == 1
+                && fwrite(&tag_size, sizeof(uint64_t), 1, file) == 1
+                && fwrite(tag.c_str(), 1, tag_size, file) == tag_size
+                && fwrite(&size, sizeof(uint64_t), 1, file) == 1
+                && (size == 0 || fwrite(&buffer[0], 1, size, file) == size)
+                && fflush(file) == 0
+                && fsync(fileno(file)) == 0;
+
+    if (fclose(file) != 0 || !written || rename(temporary_filename.c_str(), filename.c_str()) != 0) {
+        throw string("could not write checkpoint file '" + filename + "'.");
+    }
+}
+
+bool Checkpoint::load(const string &filename, const string &tag) throw (string) {
+    FILE *file = fopen(filename.c_str(), "rb");
+    if (file == NULL) return false;
+
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    uint64_t tag_size = 0, size = 0;
+    string file_tag;
+
+    bool valid = fread(magic, sizeof(magic), 1, file) == 1 && memcmp(magic, CHECKPOINT_MAGIC, sizeof(magic)) == 0
+              && fread(&tag_size, sizeof(uint64_t), 1, file) == 1 && tag_size < 1024;
+
+    if (valid) {
+        file_tag.resize(tag_size);
+        valid = (tag_size == 0 || fread(&file_tag[0], 1, tag_size, file) == tag_size) && fread(&size, sizeof(uint64_t), 1, file) == 1;
+    }
+
+    if (valid) {
+        buffer.resize(size);
+        valid = size == 0 || fread(&buffer[0], 1, size, file) == size;
+    }
+    read_position = 0;
+    fclose(file);
+
+    if (!valid) throw string("'" + filename + "' is not a complete checkpoint file.");
+    if (file_tag != tag) throw string("'" + filename + "' is a checkpoint of a " + file_tag + " search, not a " + tag + " search.");
+
+    return true;
+}
+
+
+CheckpointWriter::CheckpointWriter(const string &_filename, const string &_tag, uint32_t _interval) : filename(_filename), tag(_tag), interval(_interval), last_checkpoint(chrono::steady_clock::now()), writing(false) {
+}
+
+CheckpointWriter::~CheckpointWriter() {
+    if (writer.joinable()) writer.join();
+}
+
+bool CheckpointWriter::due() const {
+    return !writing && chrono::steady_clock::now() - last_checkpoint >= chrono::seconds(interval);
+}
+
+void CheckpointWriter::write_pending() {
+    try {
+        pending.save(filename, tag);
+    } catch (string err_msg) {
+        cerr << "could not write checkpoint: " << err_msg << endl;
+    }
+    writing = false;
+}
+
+void CheckpointWriter::write(Checkpoint &checkpoint) {
+    if (writer.joinable()) writer.join();
+
+    last_checkpoint = chrono::steady_clock::now();
+    pending.swap(checkpoint);
+    checkpoint.clear();
+
+    writing = true;
+    writer = thread(&CheckpointWriter::write_pending, this);
+}
+
+void CheckpointWriter::finish(Checkpoint &checkpoint) {
+    write(checkpoint);
+    writer.join();
+}
@@ -0,0 +1,125 @@
+#ifndef TAO_MPI_CHECKPOINT_H
+#define TAO_MPI_CHECKPOINT_H
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "stdint.h"
+
+using std::string;
+using std::vector;
+
+/**
+ *  A binary snapshot of a search, written and read in the same order. Values are stored as they are
+ *  in memory, so a checkpoint can only be read on the same kind of machine it was written on.
+ */
+class Checkpoint {
+    private:
+        vector<char> buffer;
+        size_t read_position;
+
+        void read_bytes(void *destination, size_t size) throw (string);
+
+    public:
+        Checkpoint();
+
+        void clear();
+        void swap(Checkpoint &other);
+
+        template <typename V>
+        void write(const V &value) {
+            const char *bytes = reinterpret_cast<const char*>(&value);
+            buffer.insert(buffer.end(), bytes, bytes + sizeof(V));
+        }
+
+        template <typename V>
+        void read(V &value) throw (string) {
+            read_bytes(&value, sizeof(V));
+        }
+
+        template <typename V>
+        void write_vector(const vector<V> &values) {
+            write((uint64_t)values.size());
+            if (values.size() > 0) {
+                const char *bytes = reinterpret_cast<const char*>(&values[0]);
+                buffer.insert(buffer.end(), bytes, bytes + (values.size() * sizeof(V)));
+            }
+        }
+
+        template <typename V>
+        void read_vector(vector<V> &values) throw (string) {
+            uint64_t size;
+            read(size);
+            if (size > (buffer.size() - read_position) / sizeof(V)) throw string("checkpoint is truncated.");
+
+            values.resize(size);
+            if (size > 0) read_bytes(&values[0], size * sizeof(V));
+        }
+
+        template <typename V>
+        void write_vectors(const vector< vector<V> > &values) {
+            write((uint64_t)values.size());
+            for (uint32_t i = 0; i < values.size(); i++) write_vector(values[i]);
+        }
+
+        template <typename V>
+        void read_vectors(vector< vector<V> > &values) throw (string) {
+            uint64_t size;
+            read(size);
+            if (size > buffer.size() - read_position) throw string("checkpoint is truncated.");
+
+            values.resize(size);
+            for (uint32_t i = 0; i < values.size(); i++) read_vector(values[i]);
+        }
+
+        void write_string(const string &value);
+        void read_string(string &value) throw (string);
+
+        //the generator's state is kept in the standard text form
+        void write_generator(const std::mt19937 &generator);
+        void read_generator(std::mt19937 &generator) throw (string);
+
+        //the file starts with a tag for the kind of search, which must match when it is read back
+        void save(const string &filename, const string &tag) const throw (string);
+        bool load(const string &filename, const string &tag) throw (string);     //false if there is no file
+};
+
+/**
+ *  Writes checkpoints of the master's search every interval seconds. The search is copied into a
+ *  Checkpoint by the master, and the file is written by another thread; if the previous checkpoint is
+ *  still being written when the next is due, the next one is skipped. Each checkpoint is written to a
+ *  temporary file which is synced and renamed over the previous one, so a run killed while writing
+ *  still has the last complete checkpoint.
+ */
+class CheckpointWriter {
+    private:
+        string filename;
+        string tag;
+        uint32_t interval;
+        std::chrono::steady_clock::time_point last_checkpoint;
+
+        Checkpoint pending;
+        std::thread writer;
+        std::atomic<bool> writing;
+
+        void write_pending();
+
+    public:
+        CheckpointWriter(const string &filename, const string &tag, uint32_t interval);
+        ~CheckpointWriter();
+
+        bool due() const;
+
+        //takes the contents of checkpoint
+        void write(Checkpoint &checkpoint);
+
+        //waits for the file to be written
+        void finish(Checkpoint &checkpoint);
+};
+
+#endif
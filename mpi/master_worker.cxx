@@ -2,245 +2,1646 @@
 #include <iostream>
 #include <iomanip>
 #include <queue>
+#include <deque>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include <atomic>
 #include <limits>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+#include <cstring>
+#include <ctime>
 
 #include "mpi.h"
 
 #include "asynchronous_algorithms/particle_swarm.hxx"
 
+#include "mpi/checkpoint.hxx"
 #include "mpi/master_worker.hxx"
+#include "mpi/telemetry.hxx"
 #include "mpi/mpi_genetic_algorithm.hxx"
 #include "mpi/mpi_particle_swarm.hxx"
 #include "mpi/mpi_differential_evolution.hxx"
+#include "mpi/mpi_asynchronous_newton_method.hxx"
 
 #include "util/arguments.hxx"
 
 using namespace std;
 
+//seconds, usable without MPI having been initialized (unlike MPI_Wtime)
+static double wall_time() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
 
+/**
+ *  Everything sent between the master and a worker about an individual is a single message:
+ *      double fitness, uint32_t position, uint32_t generation, T parameters[number_parameters]
+ *  The fitness is unused in the assignments the master sends, and the worker sends the rest back
+ *  unchanged with its result. The buffer is allocated once and reused for every message, so nothing
+ *  is allocated per evaluation.
+ */
 template <typename T>
-struct mpi_type_wrapper {
-    MPI_Datatype mpi_type;
-    mpi_type_wrapper();
+class IndividualMessage {
+    private:
+        uint32_t number_parameters;
+        vector<char> buffer;
+        MPI_Comm comm;
+
+        static const size_t POSITION_OFFSET = sizeof(double);
+        static const size_t GENERATION_OFFSET = sizeof(double) + sizeof(uint32_t);
+        static const size_t PARAMETERS_OFFSET = sizeof(double) + sizeof(uint64_t);
+
+    public:
+        static size_t size(uint32_t number_parameters) {
+            return PARAMETERS_OFFSET + (number_parameters * sizeof(T));
+        }
+
+        IndividualMessage(uint32_t _number_parameters, MPI_Comm _comm = MPI_COMM_WORLD) : number_parameters(_number_parameters), buffer(PARAMETERS_OFFSET + (_number_parameters * sizeof(T)), 0), comm(_comm) {}
+
+        void pack(uint32_t position, uint32_t generation, const vector<T> &individual, double fitness = 0.0) {
+            memcpy(&buffer[0], &fitness, sizeof(double));
+            memcpy(&buffer[POSITION_OFFSET], &position, sizeof(uint32_t));
+            memcpy(&buffer[GENERATION_OFFSET], &generation, sizeof(uint32_t));
+            memcpy(&buffer[PARAMETERS_OFFSET], &individual[0], number_parameters * sizeof(T));
+        }
+
+        void set_fitness(double fitness) {
+            memcpy(&buffer[0], &fitness, sizeof(double));
+        }
+
+        //individual must already hold number_parameters values
+        void unpack(uint32_t &position, uint32_t &generation, vector<T> &individual, double &fitness) const {
+            memcpy(&fitness, &buffer[0], sizeof(double));
+            memcpy(&position, &buffer[POSITION_OFFSET], sizeof(uint32_t));
+            memcpy(&generation, &buffer[GENERATION_OFFSET], sizeof(uint32_t));
+            memcpy(&individual[0], &buffer[PARAMETERS_OFFSET], number_parameters * sizeof(T));
+        }
+
+        uint32_t get_position() const {
+            uint32_t position;
+            memcpy(&position, &buffer[POSITION_OFFSET], sizeof(uint32_t));
+            return position;
+        }
+
+        void send(int target, int tag) {
+            MPI_Send(&buffer[0], buffer.size(), MPI_BYTE, target, tag, comm);
+        }
+
+        void receive(int source, int tag, MPI_Status &status) {
+            MPI_Recv(&buffer[0], buffer.size(), MPI_BYTE, source, tag, comm, &status);
+        }
+
+        //the buffer must not be touched until the request completes
+        void start_send(int target, int tag, MPI_Request &request) {
+            MPI_Isend(&buffer[0], buffer.size(), MPI_BYTE, target, tag, comm, &request);
+        }
+
+        //a persistent receive into the buffer, started with MPI_Start and reused for every message
+        void init_receive(int source, int tag, MPI_Request &request) {
+            MPI_Recv_init(&buffer[0], buffer.size(), MPI_BYTE, source, tag, comm, &request);
+        }
 };
 
-template <>
-mpi_type_wrapper<int>::mpi_type_wrapper() : mpi_type(MPI_INT) {}
+/**
+ *  Non-blocking sends from the master. A worker has at most max_queue_size assignments outstanding and
+ *  has received an assignment before it reports its result, so each worker gets a ring of max_queue_size
+ *  buffers; when a buffer comes around again its previous send has already been matched.
+ */
+template <typename T>
+class AssignmentSender {
+    private:
+        int max_queue_size;
+        vector< IndividualMessage<T> > messages;
+        vector<MPI_Request> requests;
+        vector<int> next;
 
-template <>
-mpi_type_wrapper<double>::mpi_type_wrapper() : mpi_type(MPI_DOUBLE) {}
+    public:
+        AssignmentSender(int number_workers, int _max_queue_size, uint32_t number_parameters, MPI_Comm comm) : max_queue_size(_max_queue_size), messages(number_workers * _max_queue_size, IndividualMessage<T>(number_parameters, comm)), requests(number_workers * _max_queue_size, MPI_REQUEST_NULL), next(number_workers, 0) {}
 
-template<typename T>
-void send_individual(int target, MPI_Datatype MPI_DATATYPE, const vector<T> &individual, int individual_position) {
-    MPI_Send(&individual[0], individual.size(), MPI_DATATYPE, target, REQUEST_INDIVIDUALS_TAG, MPI_COMM_WORLD);
-    //cout << "[master      ] sent new individual" << endl;
+        void send(int target, int tag, uint32_t position, uint32_t generation, const vector<T> &individual) {
+            int worker = target - 1;
+            int slot = (worker * max_queue_size) + next[worker];
+            next[worker] = (next[worker] + 1) % max_queue_size;
+
+            MPI_Wait(&requests[slot], MPI_STATUS_IGNORE);
+
+            messages[slot].pack(position, generation, individual);
+            messages[slot].start_send(target, tag, requests[slot]);
+        }
+
+        void wait_all() {
+            MPI_Waitall(requests.size(), &requests[0], MPI_STATUSES_IGNORE);
+        }
+};
+
+
+/**
+ *  An assignment sent to a worker or a result sent back from one, for the transports that do not pack
+ *  them into MPI messages. The individual is allocated once and copied into.
+ */
+template <typename T>
+struct WorkerResult {
+    int worker;
+    uint32_t position;
+    uint32_t generation;
+    double fitness;
+    vector<T> individual;
+
+    WorkerResult(uint32_t number_parameters) : worker(0), position(0), generation(0), fitness(0.0), individual(number_parameters, 0) {}
+};
+
+/**
+ *  How the master reaches its workers, which are numbered 0 .. get_number_workers() - 1. The master
+ *  keeps every worker's queue full itself, by sending one assignment for each result it receives.
+ */
+template <typename T>
+class MasterTransport {
+    public:
+        virtual ~MasterTransport() {}
+
+        virtual int get_number_workers() const = 0;
+
+        //bytes in each assignment or result
+        virtual size_t get_message_size() const = 0;
+
+        //does not wait for the worker to take the assignment
+        virtual void send(int worker, uint32_t position, uint32_t generation, const vector<T> &individual) = 0;
+
+        //waits for at least one result, fills in the start of results and returns how many there were
+        virtual int receive(vector< WorkerResult<T> > &results) = 0;
+
+        //workers drop the assignments they have queued and stop, the results still arriving are ignored
+        virtual void stop() = 0;
+};
+
+/**
+ *  Workers are ranks 1 .. size - 1 of comm, running worker<T>. The master keeps a persistent receive
+ *  posted for every worker and handles whichever have completed (MPI_Waitsome) as a batch.
+ */
+template <typename T>
+class MPIMasterTransport : public MasterTransport<T> {
+    private:
+        MPI_Comm comm;
+        int number_workers;
+        uint32_t number_parameters;
+
+        //the first number_workers requests are the persistent receives for results, the rest receive the
+        //message each worker sends once it has stopped
+        vector< IndividualMessage<T> > messages;
+        vector<MPI_Request> requests;
+        vector<uint32_t> reported;
+        AssignmentSender<T> sender;
+
+        vector<int> completed;
+        vector<MPI_Status> statuses;
+
+        static int comm_size(MPI_Comm comm) {
+            int size;
+            MPI_Comm_size(comm, &size);
+            return size;
+        }
+
+    public:
+        MPIMasterTransport(MPI_Comm _comm, int max_queue_size, uint32_t _number_parameters) : comm(_comm), number_workers(comm_size(_comm) - 1), number_parameters(_number_parameters), messages(2 * number_workers, IndividualMessage<T>(_number_parameters, _comm)), requests(2 * number_workers, MPI_REQUEST_NULL), reported(number_workers, 0), sender(number_workers, max_queue_size, _number_parameters, _comm), completed(2 * number_workers, 0), statuses(2 * number_workers) {
+            for (int i = 0; i < number_workers; i++) {
+                messages[i].init_receive(i + 1, REPORT_FITNESS_TAG, requests[i]);
+            }
+            if (number_workers > 0) MPI_Startall(number_workers, &requests[0]);
+        }
+
+        int get_number_workers() const {
+            return number_workers;
+        }
+
+        size_t get_message_size() const {
+            return IndividualMessage<T>::size(number_parameters);
+        }
+
+        void send(int worker, uint32_t position, uint32_t generation, const vector<T> &individual) {
+            sender.send(worker + 1, REQUEST_INDIVIDUALS_TAG, position, generation, individual);
+        }
+
+        int receive(vector< WorkerResult<T> > &results) {
+            int number_completed;
+            MPI_Waitsome(number_workers, &requests[0], &number_completed, &completed[0], &statuses[0]);
+
+            for (int i = 0; i < number_completed; i++) {
+                int worker = completed[i];
+
+                results[i].worker = worker;
+                messages[worker].unpack(results[i].position, results[i].generation, results[i].individual, results[i].fitness);
+                reported[worker]++;
+                MPI_Start(&requests[worker]);
+            }
+            return number_completed;
+        }
+
+        /**
+         *  Workers drop the individuals they have queued when they get the terminate message, finish what
+         *  they are evaluating and then report how many results they sent in all. The results still
+         *  arriving are ignored, and the master only waits on evaluations that were already running.
+         */
+        void stop() {
+            int number_completed;
+            vector<T> empty_individual(number_parameters, 0);
+
+            IndividualMessage<T> terminate_message(number_parameters, comm);
+            terminate_message.pack(0, 0, empty_individual);
+            vector<MPI_Request> terminate_requests(number_workers, MPI_REQUEST_NULL);
+
+            for (int i = 0; i < number_workers; i++) {
+                cout << "terminating worker: " << (i + 1) << endl;
+                terminate_message.start_send(i + 1, TERMINATE_TAG, terminate_requests[i]);
+
+                messages[number_workers + i].init_receive(i + 1, TERMINATE_TAG, requests[number_workers + i]);
+            }
+            if (number_workers > 0) MPI_Startall(number_workers, &requests[number_workers]);
+
+            vector<bool> stopped(number_workers, false);
+            int remaining = number_workers;
+            while (remaining > 0) {
+                MPI_Waitsome(2 * number_workers, &requests[0], &number_completed, &completed[0], &statuses[0]);
+
+                for (int i = 0; i < number_completed; i++) {
+                    int worker = completed[i] % number_workers;
+
+                    if (completed[i] < number_workers) {
+                        reported[worker]++;
+                    } else {
+                        stopped[worker] = true;
+                    }
+
+                    if (stopped[worker] && reported[worker] == messages[number_workers + worker].get_position()) {
+                        remaining--;
+                    } else if (completed[i] < number_workers) {
+                        MPI_Start(&requests[worker]);
+                    }
+                }
+            }
+
+            //the result receives of stopped workers are still waiting on a message that will never come
+            for (int i = 0; i < number_workers; i++) {
+                int complete;
+                MPI_Test(&requests[i], &complete, MPI_STATUS_IGNORE);
+                if (!complete) {
+                    MPI_Cancel(&requests[i]);
+                    MPI_Wait(&requests[i], MPI_STATUS_IGNORE);
+                }
+            }
+
+            for (int i = 0; i < 2 * number_workers; i++) {
+                MPI_Request_free(&requests[i]);
+            }
+            if (number_workers > 0) MPI_Waitall(number_workers, &terminate_requests[0], MPI_STATUSES_IGNORE);
+            sender.wait_all();
+        }
+};
+
+/**
+ *  A fixed size queue with one thread pushing and one thread popping, neither of which locks. The
+ *  entries are reused: the producer fills in back() and then push()es it, the consumer reads front()
+ *  and then pop()s it.
+ */
+template <typename V>
+class SingleProducerQueue {
+    private:
+        vector<V> entries;
+        atomic<size_t> head;    //next entry to pop, only written by the consumer
+        atomic<size_t> tail;    //next entry to push, only written by the producer
+
+    public:
+        SingleProducerQueue(size_t capacity, const V &initial) : entries(capacity + 1, initial), head(0), tail(0) {}
+
+        bool empty() const {
+            return head.load(memory_order_acquire) == tail.load(memory_order_acquire);
+        }
+
+        bool full() const {
+            return (tail.load(memory_order_relaxed) + 1) % entries.size() == head.load(memory_order_acquire);
+        }
+
+        V& back() {
+            return entries[tail.load(memory_order_relaxed)];
+        }
 
-    MPI_Send(&individual_position, 1, MPI_INT, target, REQUEST_INDIVIDUALS_TAG, MPI_COMM_WORLD);
-    //cout << "[master       ] sent individual to " << target << endl;
+        void push() {
+            tail.store((tail.load(memory_order_relaxed) + 1) % entries.size());
+        }
+
+        V& front() {
+            return entries[head.load(memory_order_relaxed)];
+        }
+
+        void pop() {
+            head.store((head.load(memory_order_relaxed) + 1) % entries.size());
+        }
+};
+
+/**
+ *  Lets a thread wait for a condition other threads make true without locking. The waiting thread
+ *  yields for a while before sleeping, and only a sleeping thread costs notify() the lock.
+ */
+class WakeUp {
+    private:
+        mutex wake_mutex;
+        condition_variable wake_condition;
+        atomic<bool> sleeping;
+
+    public:
+        WakeUp() : sleeping(false) {}
+
+        template <typename Ready>
+        void wait(Ready ready) {
+            for (int i = 0; i < 100; i++) {
+                if (ready()) return;
+                this_thread::yield();
+            }
+
+            unique_lock<mutex> lock(wake_mutex);
+            sleeping = true;
+            //the timeout covers a notify() that checked sleeping just before it was set
+            while (!ready()) wake_condition.wait_for(lock, chrono::milliseconds(1));
+            sleeping = false;
+        }
+
+        void notify() {
+            if (sleeping) {
+                lock_guard<mutex> lock(wake_mutex);
+                wake_condition.notify_one();
+            }
+        }
+};
+
+/**
+ *  Workers are threads in this process, so a search can run (and the master's overhead can be measured)
+ *  without MPI. Each worker has a queue of assignments from the master and a queue of results back to
+ *  it; neither queue can overfill because a worker never has more than max_queue_size assignments
+ *  outstanding. The objective function must be thread safe to use more than one worker.
+ */
+template <typename T>
+class LocalMasterTransport : public MasterTransport<T> {
+    private:
+        double (*objective_function)(const std::vector<T> &);
+        int number_workers;
+        uint32_t number_parameters;
+
+        vector< unique_ptr< SingleProducerQueue< WorkerResult<T> > > > assignments;
+        vector< unique_ptr< SingleProducerQueue< WorkerResult<T> > > > results;
+        vector< unique_ptr<WakeUp> > worker_wake_ups;
+        WakeUp master_wake_up;
+
+        atomic<bool> stopping;
+        int next_worker;
+        vector<thread> threads;
+
+        bool results_waiting() const {
+            for (int i = 0; i < number_workers; i++) {
+                if (!results[i]->empty()) return true;
+            }
+            return false;
+        }
+
+        void evaluate(int worker) {
+            SingleProducerQueue< WorkerResult<T> > &queue = *assignments[worker];
+
+            while (true) {
+                worker_wake_ups[worker]->wait([&]() { return stopping || !queue.empty(); });
+                if (stopping) return;
+
+                WorkerResult<T> &assignment = queue.front();
+                double fitness = objective_function(assignment.individual);
+
+                WorkerResult<T> &result = results[worker]->back();
+                result.worker = worker;
+                result.position = assignment.position;
+                result.generation = assignment.generation;
+                result.fitness = fitness;
+                result.individual = assignment.individual;
+
+                queue.pop();
+                results[worker]->push();
+                master_wake_up.notify();
+            }
+        }
+
+    public:
+        LocalMasterTransport(double (*_objective_function)(const std::vector<T> &), int _number_workers, int max_queue_size, uint32_t _number_parameters) : objective_function(_objective_function), number_workers(_number_workers), number_parameters(_number_parameters), stopping(false), next_worker(0) {
+            for (int i = 0; i < number_workers; i++) {
+                assignments.push_back(unique_ptr< SingleProducerQueue< WorkerResult<T> > >(new SingleProducerQueue< WorkerResult<T> >(max_queue_size, WorkerResult<T>(number_parameters))));
+                results.push_back(unique_ptr< SingleProducerQueue< WorkerResult<T> > >(new SingleProducerQueue< WorkerResult<T> >(max_queue_size, WorkerResult<T>(number_parameters))));
+                worker_wake_ups.push_back(unique_ptr<WakeUp>(new WakeUp()));
+            }
+
+            for (int i = 0; i < number_workers; i++) {
+                threads.push_back(thread(&LocalMasterTransport<T>::evaluate, this, i));
+            }
+        }
+
+        ~LocalMasterTransport() {
+            stop();
+        }
+
+        int get_number_workers() const {
+            return number_workers;
+        }
+
+        //the same as over MPI, although here it is only copied
+        size_t get_message_size() const {
+            return IndividualMessage<T>::size(number_parameters);
+        }
+
+        void send(int worker, uint32_t position, uint32_t generation, const vector<T> &individual) {
+            SingleProducerQueue< WorkerResult<T> > &queue = *assignments[worker];
+            while (queue.full()) this_thread::yield();
+
+            WorkerResult<T> &assignment = queue.back();
+            assignment.worker = worker;
+            assignment.position = position;
+            assignment.generation = generation;
+            assignment.individual = individual;
+
+            queue.push();
+            worker_wake_ups[worker]->notify();
+        }
+
+        int receive(vector< WorkerResult<T> > &received) {
+            master_wake_up.wait([&]() { return results_waiting(); });
+
+            //start from a different worker each time so none is favoured when results are cut off
+            int number_received = 0;
+            for (int i = 0; i < number_workers && number_received < (int)received.size(); i++) {
+                int worker = (next_worker + i) % number_workers;
+                SingleProducerQueue< WorkerResult<T> > &queue = *results[worker];
+
+                while (!queue.empty() && number_received < (int)received.size()) {
+                    received[number_received] = queue.front();
+                    queue.pop();
+                    number_received++;
+                }
+            }
+            next_worker = (next_worker + 1) % number_workers;
+
+            return number_received;
+        }
+
+        void stop() {
+            stopping = true;
+            for (int i = 0; i < (int)threads.size(); i++) {
+                worker_wake_ups[i]->notify();
+                threads[i].join();
+            }
+            threads.clear();
+        }
+};
+
+/**
+ *  Keeps track of the assignments the master has outstanding. Each assignment is numbered (its
+ *  generation) and the worker sends the number back with its result. A copy of an assignment that was
+ *  re-issued to another worker keeps the number, so whichever result arrives first is used and the
+ *  later one is dropped as stale.
+ *
+ *  If positions are slots of the search's population, a result is also dropped as stale if the result
+ *  of a newer generation of its position has already been used, so an older individual never replaces
+ *  a newer one in its slot.
+ *
+ *  If percentile > 0, an assignment outstanding longer than factor times that percentile of the recent
+ *  latencies is re-issued to the next worker that reports a result, instead of a new individual. The
+ *  latency is the time from sending an assignment to receiving its result, so with a queue size above
+ *  one it includes the time spent in the worker's queue behind its other assignments.
+ */
+template <typename T>
+class StragglerTracker {
+    private:
+        struct Assignment {
+            uint32_t position;
+            int worker;
+            double issued;
+            bool reissued;
+            vector<T> individual;
+        };
+
+        static const uint32_t LATENCY_SAMPLES = 1000;
+        static const uint32_t THRESHOLD_UPDATE = 100;
+
+        double percentile;
+        double factor;
+        bool slots;
+
+        uint32_t next_generation;
+        map<uint32_t, Assignment> outstanding;      //ordered by generation, so the oldest are first
+        map<uint32_t, uint32_t> latest;             //the newest generation used for each position, if they are slots
+
+        vector<double> latencies;
+        uint32_t next_latency;
+        uint32_t new_latencies;
+        double threshold;
+
+        vector<double> worker_latency;              //moving average for each worker
+        uint32_t reissued;
+        uint32_t stale;
+
+    public:
+        StragglerTracker(int number_workers, double _percentile, double _factor, bool _slots) : percentile(_percentile), factor(_factor), slots(_slots), next_generation(0), next_latency(0), new_latencies(0), threshold(0.0), worker_latency(number_workers, 0.0), reissued(0), stale(0) {}
+
+        //returns the generation of the new assignment
+        uint32_t issue(int worker, uint32_t position, const vector<T> &individual) {
+            Assignment &assignment = outstanding[next_generation];
+            assignment.position = position;
+            assignment.worker = worker;
+            assignment.issued = wall_time();
+            assignment.reissued = false;
+            if (percentile > 0.0) assignment.individual.assign(individual.begin(), individual.end());
+
+            return next_generation++;
+        }
+
+        uint32_t get_outstanding() const {
+            return outstanding.size();
+        }
+
+        /**
+         *  Returns false if the result is stale and should be ignored. The latency is negative if it is
+         *  not known, because the individual was re-issued or its copy already reported.
+         */
+        bool complete(uint32_t generation, int worker, double &latency) {
+            latency = -1.0;
+
+            typename map<uint32_t, Assignment>::iterator it = outstanding.find(generation);
+            if (it == outstanding.end()) {
+                stale++;
+                return false;
+            }
+
+            if (!it->second.reissued && it->second.worker == worker) {
+                latency = wall_time() - it->second.issued;
+
+                if (worker_latency[worker] == 0.0) worker_latency[worker] = latency;
+                else worker_latency[worker] = (0.9 * worker_latency[worker]) + (0.1 * latency);
+
+                if (latencies.size() < LATENCY_SAMPLES) latencies.push_back(latency);
+                else latencies[next_latency] = latency;
+                next_latency = (next_latency + 1) % LATENCY_SAMPLES;
+
+                new_latencies++;
+                if (percentile > 0.0 && new_latencies >= THRESHOLD_UPDATE) {
+                    vector<double> sorted(latencies);
+                    uint32_t n = min((uint32_t)sorted.size() - 1, (uint32_t)(percentile * sorted.size()));
+                    nth_element(sorted.begin(), sorted.begin() + n, sorted.end());
+                    threshold = factor * sorted[n];
+                    new_latencies = 0;
+                }
+            }
+
+            bool current = true;
+            if (slots) {
+                typename map<uint32_t, uint32_t>::iterator newest = latest.find(it->second.position);
+                if (newest != latest.end() && newest->second > generation) {
+                    stale++;
+                    current = false;
+                } else {
+                    latest[it->second.position] = generation;
+                }
+            }
+
+            outstanding.erase(it);
+            return current;
+        }
+
+        //if an assignment held by another worker is overdue, copies it out to be sent to worker and returns true
+        bool take_overdue(int worker, uint32_t &generation, uint32_t &position, vector<T> &individual) {
+            if (threshold <= 0.0) return false;
+
+            double now = wall_time();
+            for (typename map<uint32_t, Assignment>::iterator it = outstanding.begin(); it != outstanding.end(); it++) {
+                if (now - it->second.issued < threshold) break;
+                if (it->second.reissued || it->second.worker == worker) continue;
+
+                it->second.reissued = true;
+                generation = it->first;
+                position = it->second.position;
+                individual.assign(it->second.individual.begin(), it->second.individual.end());
+                reissued++;
+                return true;
+            }
+            return false;
+        }
+
+        void print_statistics() {
+            if (worker_latency.empty()) return;
+
+            uint32_t fastest = min_element(worker_latency.begin(), worker_latency.end()) - worker_latency.begin();
+            uint32_t slowest = max_element(worker_latency.begin(), worker_latency.end()) - worker_latency.begin();
+
+            cout << "[master      ] worker latency fastest (" << (fastest + 1) << "): " << worker_latency[fastest] << ", slowest (" << (slowest + 1) << "): " << worker_latency[slowest] << endl;
+            if (percentile > 0.0) cout << "[master      ] re-issued " << reissued << " straggling individuals, " << stale << " stale results ignored." << endl;
+        }
+};
+
+/**
+ *  A sub-master's side of the exchange with the root. Every migration_interval results it sends its
+ *  best individual to the root (rank 0 of the leaders communicator) and the root replies with the
+ *  global best, which is inserted into the island if it is better than the island's own. Only one
+ *  exchange is outstanding at a time, and the search is never blocked waiting on the reply.
+ */
+template <typename T>
+class Migration {
+    private:
+        int interval;
+        int results;
+        bool waiting;
+
+        IndividualMessage<T> outgoing;
+        IndividualMessage<T> incoming;
+        MPI_Request send_request;
+        MPI_Request receive_request;
+        vector<T> migrant;
+
+        template <typename EvolutionaryAlgorithmsType>
+        void send_best(EvolutionaryAlgorithmsType *ea, uint32_t finished) {
+            MPI_Wait(&send_request, MPI_STATUS_IGNORE);
+
+            vector<T> best = ea->get_global_best();
+            if (best.size() != migrant.size()) best.assign(migrant.size(), 0);
+
+            //the position is used to tell the root this island has finished
+            outgoing.pack(finished, 0, best, ea->get_global_best_fitness());
+            outgoing.start_send(0, MIGRATION_TAG, send_request);
+
+            if (!finished) {
+                MPI_Start(&receive_request);
+                waiting = true;
+            }
+        }
+
+        template <typename EvolutionaryAlgorithmsType>
+        void receive_global_best(EvolutionaryAlgorithmsType *ea) {
+            uint32_t position, generation;
+            double fitness;
+            incoming.unpack(position, generation, migrant, fitness);
+            waiting = false;
+
+            if (fitness > ea->get_global_best_fitness()) ea->insert_migrant(migrant, fitness);
+        }
+
+    public:
+        Migration(MPI_Comm leaders, int _interval, uint32_t number_parameters) : interval(_interval), results(0), waiting(false), outgoing(number_parameters, leaders), incoming(number_parameters, leaders), send_request(MPI_REQUEST_NULL), receive_request(MPI_REQUEST_NULL), migrant(number_parameters, 0) {
+            incoming.init_receive(0, MIGRATION_TAG, receive_request);
+        }
+
+        ~Migration() {
+            MPI_Request_free(&receive_request);
+        }
+
+        template <typename EvolutionaryAlgorithmsType>
+        void update(EvolutionaryAlgorithmsType *ea, int new_results) {
+            results += new_results;
+
+            if (waiting) {
+                int arrived;
+                MPI_Test(&receive_request, &arrived, MPI_STATUS_IGNORE);
+                if (!arrived) return;
+
+                receive_global_best(ea);
+            }
+
+            if (results >= interval) {
+                send_best(ea, 0);
+                results = 0;
+            }
+        }
+
+        template <typename EvolutionaryAlgorithmsType>
+        void finish(EvolutionaryAlgorithmsType *ea) {
+            if (waiting) {
+                MPI_Wait(&receive_request, MPI_STATUS_IGNORE);
+                receive_global_best(ea);
+            }
+
+            send_best(ea, 1);
+            MPI_Wait(&send_request, MPI_STATUS_IGNORE);
+        }
+};
+
+MasterWorkerOptions::MasterWorkerOptions(const vector<string> &arguments) {
+    int initialized;
+    MPI_Initialized(&initialized);
+
+    int rank = 0, max_rank = 1;
+    if (initialized) {
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        MPI_Comm_size(MPI_COMM_WORLD, &max_rank);
+    }
+
+    if (!get_argument(arguments, "--max_queue_size", false, max_queue_size)) {
+        if (rank == 0) {
+            cout << "Argument '--max_queue_size <I>' not found, using default of 3." << endl;
+        }
+        max_queue_size = 3;
+    }
+
+    worker_threads = 1;
+    get_argument(arguments, "--worker_threads", false, worker_threads);
+    if (worker_threads == 0) worker_threads = max(1u, thread::hardware_concurrency());
+
+    straggler_percentile = 0.0;
+    straggler_factor = 2.0;
+    if (get_argument(arguments, "--straggler_percentile", false, straggler_percentile)) {
+        if (!get_argument(arguments, "--straggler_factor", false, straggler_factor) && rank == 0) {
+            cout << "Argument '--straggler_factor <F>' not found, using default of " << straggler_factor << "." << endl;
+        }
+    }
+
+    group_size = 0;
+    migration_interval = 1000;
+    if (get_argument(arguments, "--group_size", false, group_size)) {
+        if (!get_argument(arguments, "--migration_interval", false, migration_interval) && rank == 0) {
+            cout << "Argument '--migration_interval <I>' not found, using default of " << migration_interval << "." << endl;
+        }
+    }
+
+    generational = argument_exists(arguments, "--generational");
+
+    checkpoint_interval = 300;
+    if (get_argument(arguments, "--checkpoint", false, checkpoint_filename)) {
+        if (!get_argument(arguments, "--checkpoint_interval", false, checkpoint_interval) && rank == 0) {
+            cout << "Argument '--checkpoint_interval <I>' not found, using default of " << checkpoint_interval << " seconds." << endl;
+        }
+    }
+
+    telemetry_interval = 10;
+    if (get_argument(arguments, "--telemetry", false, telemetry_filename)) {
+        if (!get_argument(arguments, "--telemetry_interval", false, telemetry_interval) && rank == 0) {
+            cout << "Argument '--telemetry_interval <I>' not found, using default of " << telemetry_interval << " seconds." << endl;
+        }
+    }
+
+    local_workers = 0;
+    if (max_rank == 1) {
+        if (!get_argument(arguments, "--local_workers", false, local_workers)) {
+            cout << "Argument '--local_workers <I>' not found, using default of 1." << endl;
+            local_workers = 1;
+        }
+        if (local_workers == 0) local_workers = max(1u, thread::hardware_concurrency());
+    }
 }
 
 
+/**
+ *  Checks the progress of the search after a new individual is generated, returns true when it should stop.
+ */
+template<typename EvolutionaryAlgorithmsType>
+bool update_progress(EvolutionaryAlgorithmsType *ea, double start_time, int &last_printed_iteration, double &previous_best_fitness, int &unchanged_fitnesses) {
+    bool finished = false;
+
+    if ((ea->get_current_iteration() % 25 == 0) && ea->get_current_iteration() != last_printed_iteration) {
+        last_printed_iteration = ea->get_current_iteration();
+
+        if (previous_best_fitness == ea->get_global_best_fitness()) {
+            unchanged_fitnesses++;
+
+            if (unchanged_fitnesses >= 50) {
+                finished = true;
+            }
+        } else {
+            previous_best_fitness = ea->get_global_best_fitness();
+            unchanged_fitnesses = 0;
+        }
+
+        cout.precision(10);
+        cout << setw(10) << ea->get_current_iteration() << setw(20) << ea->get_global_best_fitness() << endl;
+
+        if (ea->print_statistics != NULL) {
+            ea->print_statistics(ea->get_global_best());
+        }
+        //cout <<  ea->get_current_iteration() << ":" << ea->get_global_best_fitness() << " " << vector_to_string( ea->get_global_best() ) << endl;
+    }
+
+    if (!ea->is_running() || finished) {
+        cout << endl;
+        cout << "[master      ] completed in " << (wall_time() - start_time) << " seconds." << endl;
+
+        cout.precision(10);
+        cout << ea->get_current_iteration() << ":" << ea->get_global_best_fitness() << " " << vector_to_string( ea->get_global_best() ) << endl;
+        cout << ea->get_current_iteration() << endl;
+        cout << vector_to_string( ea->get_global_best() ) << endl;
+        cout << ea->get_global_best_fitness() << endl;
+
+        return true;
+    }
+    return false;
+}
+
+/**
+ *  Checkpoints are written for the searches that can be resumed from one, the tag names the kind of
+ *  search in the file and is empty for the others.
+ */
+template<typename EvolutionaryAlgorithmsType>
+string checkpoint_tag(EvolutionaryAlgorithmsType *ea) { return ""; }
+static string checkpoint_tag(ParticleSwarmMPI *ea) { return "particle_swarm"; }
+static string checkpoint_tag(DifferentialEvolutionMPI *ea) { return "differential_evolution"; }
+
+template<typename EvolutionaryAlgorithmsType>
+void write_search(EvolutionaryAlgorithmsType *ea, Checkpoint &checkpoint) {}
+static void write_search(ParticleSwarmMPI *ea, Checkpoint &checkpoint) { ea->write_checkpoint(checkpoint); }
+static void write_search(DifferentialEvolutionMPI *ea, Checkpoint &checkpoint) { ea->write_checkpoint(checkpoint); }
+
+template<typename EvolutionaryAlgorithmsType>
+void read_search(EvolutionaryAlgorithmsType *ea, Checkpoint &checkpoint) {}
+static void read_search(ParticleSwarmMPI *ea, Checkpoint &checkpoint) throw (string) { ea->read_checkpoint(checkpoint); }
+static void read_search(DifferentialEvolutionMPI *ea, Checkpoint &checkpoint) throw (string) { ea->read_checkpoint(checkpoint); }
+
+/**
+ *  The positions of particle swarm and differential evolution individuals are the slots of their
+ *  population. For the others many individuals share a position (the iteration of an asynchronous
+ *  newton method), it is ignored (genetic algorithm) or it is never reused (the tickets of a multi search).
+ */
+template<typename EvolutionaryAlgorithmsType>
+bool positions_are_slots(EvolutionaryAlgorithmsType *ea) { return false; }
+static bool positions_are_slots(ParticleSwarmMPI *ea) { return true; }
+static bool positions_are_slots(DifferentialEvolutionMPI *ea) { return true; }
+
+/**
+ *  Resumes the search from its checkpoint file if there is one, and returns the writer for its
+ *  checkpoints (NULL if they are not used).
+ */
+template<typename EvolutionaryAlgorithmsType>
+CheckpointWriter* start_checkpoints(EvolutionaryAlgorithmsType *ea, const MasterWorkerOptions &options) {
+    if (options.checkpoint_filename.empty()) return NULL;
+
+    string tag = checkpoint_tag(ea);
+    if (tag.empty()) {
+        cerr << "Argument '--checkpoint <file>' is not used by this search." << endl;
+        return NULL;
+    }
+
+    try {
+        Checkpoint checkpoint;
+        if (checkpoint.load(options.checkpoint_filename, tag)) {
+            read_search(ea, checkpoint);
+            cout << "[master      ] resumed from checkpoint '" << options.checkpoint_filename << "' at iteration " << ea->get_current_iteration() << endl;
+        }
+    } catch (string err_msg) {
+        cerr << "could not resume from checkpoint: " << err_msg << endl;
+        exit(1);
+    }
+
+    return new CheckpointWriter(options.checkpoint_filename, tag, options.checkpoint_interval);
+}
+
+/**
+ *  Returns the telemetry for a master (NULL if it is not used), sub-masters add a suffix for their
+ *  group before the file's extension.
+ */
+template<typename T>
+MasterTelemetry* start_telemetry(const MasterTransport<T> &transport, const MasterWorkerOptions &options, const string &suffix) {
+    if (options.telemetry_filename.empty()) return NULL;
+
+    string filename = options.telemetry_filename;
+    size_t extension = filename.find_last_of('.');
+    if (extension == string::npos || filename.find('/', extension) != string::npos) extension = filename.size();
+    filename.insert(extension, suffix);
+
+    try {
+        return new MasterTelemetry(filename, options.telemetry_interval, transport.get_number_workers(), transport.get_message_size());
+    } catch (string err_msg) {
+        cerr << err_msg << endl;
+        return NULL;
+    }
+}
+
+/**
+ *  Every worker is kept max_queue_size individuals ahead: it is sent that many to start with, and one
+ *  more for each result it reports. The results that arrive together are handled as a batch: they are
+ *  inserted before the new individuals are generated and sent.
+ */
 template<typename EvolutionaryAlgorithmsType, typename T>
-void master(EvolutionaryAlgorithmsType *ea) {
-    int max_rank, rank;
-    uint32_t individual_position;
-    MPI_Status status;
+void run_master(EvolutionaryAlgorithmsType *ea, MasterTransport<T> &transport, int max_queue_size, Migration<T> *migration, CheckpointWriter *checkpoints, MasterTelemetry *telemetry, double straggler_percentile, double straggler_factor) {
+    uint32_t individual_position, generation;
     int number_parameters = ea->get_number_parameters();
-    T individual[number_parameters];
 
-    mpi_type_wrapper<T> parameter_type;
-    MPI_Datatype MPI_DATATYPE = parameter_type.mpi_type;
+    if (max_queue_size < 1) max_queue_size = 1;
 
-    MPI_Comm_size(MPI_COMM_WORLD, &max_rank);
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    int number_workers = transport.get_number_workers();
+
+    vector< WorkerResult<T> > results(max(1, number_workers * max_queue_size), WorkerResult<T>(number_parameters));
+    StragglerTracker<T> stragglers(number_workers, straggler_percentile, straggler_factor, positions_are_slots(ea));
+    int number_completed;
+
+    vector<T> new_individual(number_parameters, 0);
+    Checkpoint checkpoint;
 
     int last_printed_iteration = 1;
     bool finished = false;
     double previous_best_fitness = -std::numeric_limits<double>::max();
     int unchanged_fitnesses = 0;
 
-    double start_time = MPI_Wtime();
+    double start_time = wall_time();
 
-    for (int i = 1; i < max_rank; i++) {
-        vector<T> new_individual(ea->get_number_parameters(), 0);
-        ea->new_individual(individual_position, new_individual);
-//        cout << "[master      ] generated new individual" << endl;
+    for (int j = 0; j < max_queue_size; j++) {
+        for (int i = 0; i < number_workers; i++) {
+            ea->new_individual(individual_position, new_individual);
+//            cout << "[master      ] generated new individual" << endl;
 
-        send_individual(i, MPI_DATATYPE, new_individual, individual_position);
+            generation = stragglers.issue(i, individual_position, new_individual);
+            transport.send(i, individual_position, generation, new_individual);
+            if (telemetry != NULL) telemetry->sent(i);
+        }
     }
 
-    while (true) {
-        //Wait on a message from any worker
+    while (!finished && number_workers > 0) {
+        if (telemetry != NULL) {
+            double wait_start = wall_time();
+            number_completed = transport.receive(results);
+            telemetry->received_batch(number_completed, wall_time() - wait_start);
+        } else {
+            number_completed = transport.receive(results);
+        }
 
-        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+        for (int i = 0; i < number_completed; i++) {
+            //cout << "[master      ] received fitness: " << results[i].fitness << " on iteration: " << ea->get_current_iteration() << endl;
+            double latency;
+            bool current = stragglers.complete(results[i].generation, results[i].worker, latency);
+            if (current) {
+                ea->insert_individual(results[i].position, results[i].individual, results[i].fitness);
+            }
+            if (telemetry != NULL) telemetry->received(results[i].worker, latency, !current);
+        }
 
-        int source = status.MPI_SOURCE;
+        for (int i = 0; i < number_completed; i++) {
+            int worker = results[i].worker;
 
-        double fitness = 0;
+            if (!stragglers.take_overdue(worker, generation, individual_position, new_individual)) {
+                ea->new_individual(individual_position, new_individual);
+                //cout << "[master      ] generated individual" << endl;
 
-        //cout << "[master     ] receiving fitness." << endl;
-        MPI_Recv(&fitness, 1, MPI_DOUBLE, source, REPORT_FITNESS_TAG, MPI_COMM_WORLD, &status);
-        //cout << "[master     ] receiving " << number_parameters << " parameters." << endl;
-        MPI_Recv(individual, number_parameters, MPI_DATATYPE, source, REPORT_FITNESS_TAG, MPI_COMM_WORLD, &status);
-        //cout << "[master     ] receiving position." << endl;
-        MPI_Recv(&individual_position, 1, MPI_INT, source, REPORT_FITNESS_TAG, MPI_COMM_WORLD, &status);
+                generation = stragglers.issue(worker, individual_position, new_individual);
+            }
+            transport.send(worker, individual_position, generation, new_individual);
+            if (telemetry != NULL) telemetry->sent(worker);
 
-        //cout << "[master      ] received fitness: " << fitness << " on iteration: " << ea->get_current_iteration() << endl;
-        /*
-        cout << "[master      ] received individual: [";
-        for (int i = 0; i < number_parameters; i++) {
-            cout << " " << individual[i];
+            if (!finished) finished = update_progress(ea, start_time, last_printed_iteration, previous_best_fitness, unchanged_fitnesses);
         }
-        cout << "]" << endl;
-        */
 
-        vector<T> received_individual(individual, individual + ea->get_number_parameters());
-        ea->insert_individual(individual_position, received_individual, fitness);
+        if (migration != NULL) migration->update(ea, number_completed);
 
-        //cout << "[master      ] inserted individual" << endl;
+        //the search is copied here, the file is written by the checkpoint writer's thread
+        if (checkpoints != NULL && checkpoints->due()) {
+            write_search(ea, checkpoint);
+            checkpoints->write(checkpoint);
+        }
 
-        vector<T> new_individual(ea->get_number_parameters(), 0);
-        ea->new_individual(individual_position, new_individual);
-        //cout << "[master      ] generated individual" << endl;
+        if (telemetry != NULL) telemetry->write(stragglers.get_outstanding());
+    }
 
-        send_individual(source, MPI_DATATYPE, new_individual, individual_position);
+    if (telemetry != NULL) telemetry->write(stragglers.get_outstanding(), true);
 
-        if ((ea->get_current_iteration() % 25 == 0) && ea->get_current_iteration() != last_printed_iteration) {
-            last_printed_iteration = ea->get_current_iteration();
+    stragglers.print_statistics();
 
-            if (previous_best_fitness == ea->get_global_best_fitness()) {
-                unchanged_fitnesses++;
+    transport.stop();
 
-                if (unchanged_fitnesses >= 50) {
-                    finished = true;
+    if (checkpoints != NULL) {
+        write_search(ea, checkpoint);
+        checkpoints->finish(checkpoint);
+    }
+
+    if (migration != NULL) migration->finish(ea);
+
+    //MPI_Abort(MPI_COMM_WORLD, 0 /* success */);
+}
+
+template<typename EvolutionaryAlgorithmsType, typename T>
+void master(EvolutionaryAlgorithmsType *ea, int max_queue_size, MPI_Comm comm) {
+    MPIMasterTransport<T> transport(comm, max_queue_size, ea->get_number_parameters());
+    run_master<EvolutionaryAlgorithmsType, T>(ea, transport, max_queue_size, NULL, NULL, NULL, 0.0, 2.0);
+}
+
+template void master<DifferentialEvolutionMPI, double>(DifferentialEvolutionMPI *ea, int max_queue_size, MPI_Comm comm);
+template void master<ParticleSwarmMPI, double>(ParticleSwarmMPI *ea, int max_queue_size, MPI_Comm comm);
+template void master<GeneticAlgorithmMPI, int>(GeneticAlgorithmMPI *ea, int max_queue_size, MPI_Comm comm);
+template void master<AsynchronousNewtonMethodMPI, double>(AsynchronousNewtonMethodMPI *ea, int max_queue_size, MPI_Comm comm);
+
+/**
+ *  Evaluation threads for a worker rank. Slots of the worker's queue are handed to the threads, which
+ *  read the individual from the slot's message and write the fitness back into it; only the rank's
+ *  main thread calls MPI. The objective function must be thread safe.
+ */
+template <typename T>
+class EvaluationPool {
+    private:
+        double (*objective_function)(const std::vector<T> &);
+        uint32_t number_parameters;
+        vector< IndividualMessage<T> > &queue;
+
+        mutex pool_mutex;
+        condition_variable work_available;
+        condition_variable result_available;
+        deque<int> work;
+        deque<int> done;
+        bool stopping;
+
+        vector<thread> threads;
+
+        void evaluate() {
+            vector<T> individual(number_parameters, 0);
+            uint32_t position, generation;
+            double fitness;
+
+            while (true) {
+                int slot;
+                {
+                    unique_lock<mutex> lock(pool_mutex);
+                    while (!stopping && work.empty()) work_available.wait(lock);
+                    if (work.empty()) return;
+
+                    slot = work.front();
+                    work.pop_front();
                 }
-            } else {
-                previous_best_fitness = ea->get_global_best_fitness();
-                unchanged_fitnesses = 0;
+
+                queue[slot].unpack(position, generation, individual, fitness);
+                queue[slot].set_fitness(objective_function(individual));
+
+                {
+                    lock_guard<mutex> lock(pool_mutex);
+                    done.push_back(slot);
+                }
+                result_available.notify_one();
             }
+        }
 
-            cout.precision(10);
-            cout << setw(10) << ea->get_current_iteration() << setw(20) << ea->get_global_best_fitness() << endl;
+    public:
+        EvaluationPool(double (*_objective_function)(const std::vector<T> &), uint32_t _number_parameters, vector< IndividualMessage<T> > &_queue, int number_threads) : objective_function(_objective_function), number_parameters(_number_parameters), queue(_queue), stopping(false) {
+            for (int i = 0; i < number_threads; i++) {
+                threads.push_back(thread(&EvaluationPool<T>::evaluate, this));
+            }
+        }
 
-            if (ea->print_statistics != NULL) {
-                ea->print_statistics(ea->get_global_best());
+        ~EvaluationPool() {
+            {
+                lock_guard<mutex> lock(pool_mutex);
+                stopping = true;
             }
-            //cout <<  ea->get_current_iteration() << ":" << ea->get_global_best_fitness() << " " << vector_to_string( ea->get_global_best() ) << endl;
+            work_available.notify_all();
+
+            for (uint32_t i = 0; i < threads.size(); i++) threads[i].join();
         }
 
-        if (!ea->is_running() || finished) {
-            cout << endl;
-            cout << "[master      ] completed in " << (MPI_Wtime() - start_time) << " seconds." << endl;
+        void add(int slot) {
+            {
+                lock_guard<mutex> lock(pool_mutex);
+                work.push_back(slot);
+            }
+            work_available.notify_one();
+        }
 
-            cout.precision(10);
-            cout << ea->get_current_iteration() << ":" << ea->get_global_best_fitness() << " " << vector_to_string( ea->get_global_best() ) << endl;
-            cout << ea->get_current_iteration() << endl;
-            cout << vector_to_string( ea->get_global_best() ) << endl;
-            cout << ea->get_global_best_fitness() << endl;
+        //removes the slots no thread has started on, returns how many there were
+        int drop_queued() {
+            lock_guard<mutex> lock(pool_mutex);
+            int dropped = work.size();
+            work.clear();
+            return dropped;
+        }
+
+        //moves the finished slots into finished, waiting up to wait_microseconds for one if there are none
+        void take_finished(vector<int> &finished, int wait_microseconds) {
+            unique_lock<mutex> lock(pool_mutex);
+            if (done.empty() && wait_microseconds > 0) result_available.wait_for(lock, chrono::microseconds(wait_microseconds));
 
-            break;
+            finished.assign(done.begin(), done.end());
+            done.clear();
         }
+};
+
+/**
+ *  Tells the master how many results this worker sent and frees its receives, the ones still waiting
+ *  on a message will never get one (testing an inactive receive completes immediately).
+ */
+template <typename T>
+void stop_worker(IndividualMessage<T> &stop_message, uint32_t reported, vector<T> &individual, vector<MPI_Request> &requests) {
+    stop_message.pack(reported, 0, individual);
+    stop_message.send(0 /*master is rank 0*/, TERMINATE_TAG);
+
+    MPI_Status status;
+    for (uint32_t i = 0; i < requests.size(); i++) {
+        int complete;
+        MPI_Test(&requests[i], &complete, &status);
+        if (!complete) {
+            MPI_Cancel(&requests[i]);
+            MPI_Wait(&requests[i], &status);
+        }
+        MPI_Request_free(&requests[i]);
+    }
+}
+
+/**
+ *  A worker that keeps number_threads individuals evaluating at once (out of max_queue_size queued)
+ *  and reports each as soon as it finishes. The main thread blocks in MPI while nothing is being
+ *  evaluated, and otherwise alternates between checking for new individuals and finished ones.
+ */
+template <typename T>
+void threaded_worker(double (*objective_function)(const std::vector<T> &),
+                     int number_parameters,
+                     int max_queue_size,
+                     int number_threads,
+                     MPI_Comm comm
+                    ) {
+
+    if (max_queue_size < number_threads) max_queue_size = number_threads;
+
+    //the last slot receives the terminate message
+    vector< IndividualMessage<T> > queue(max_queue_size + 1, IndividualMessage<T>(number_parameters, comm));
+    vector<MPI_Request> requests(max_queue_size + 1, MPI_REQUEST_NULL);
+    vector<int> completed(max_queue_size + 1, 0);
+    vector<MPI_Status> statuses(max_queue_size + 1);
+    vector<int> finished;
+    vector<T> individual(number_parameters, 0);
+
+    for (int i = 0; i < max_queue_size; i++) {
+        queue[i].init_receive(0 /*master is rank 0*/, REQUEST_INDIVIDUALS_TAG, requests[i]);
     }
+    queue[max_queue_size].init_receive(0 /*master is rank 0*/, TERMINATE_TAG, requests[max_queue_size]);
+    MPI_Startall(max_queue_size + 1, &requests[0]);
 
-    for (int i = 1; i < max_rank; i++) {
-        MPI_Probe(MPI_ANY_SOURCE, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
+    EvaluationPool<T> pool(objective_function, number_parameters, queue, number_threads);
 
-        int source = status.MPI_SOURCE;
+    bool terminating = false;
+    uint32_t reported = 0;
+    int evaluating = 0;
 
-        double fitness = 0;
+    while (!terminating || evaluating > 0) {
+        int number_completed = 0;
+
+        if (!terminating) {
+            if (evaluating == 0) {
+                MPI_Waitsome(max_queue_size + 1, &requests[0], &number_completed, &completed[0], &statuses[0]);
+            } else {
+                MPI_Testsome(max_queue_size + 1, &requests[0], &number_completed, &completed[0], &statuses[0]);
+            }
+            if (number_completed == MPI_UNDEFINED) number_completed = 0;
 
+            for (int i = 0; i < number_completed; i++) {
+                if (completed[i] == max_queue_size) terminating = true;
+            }
 
-        //receive the individual the worker is sending.
+            //individuals that arrive with the terminate message are dropped with the rest of the queue
+            for (int i = 0; i < number_completed && !terminating; i++) {
+                evaluating++;
+                pool.add(completed[i]);
+            }
+            if (terminating) evaluating -= pool.drop_queued();
+        }
 
-        //cout << "[master     ] receiving fitness." << endl;
-        MPI_Recv(&fitness, 1, MPI_DOUBLE, source, REPORT_FITNESS_TAG, MPI_COMM_WORLD, &status);
-        //cout << "[master     ] receiving " << number_parameters << " parameters." << endl;
-        MPI_Recv(individual, number_parameters, MPI_DATATYPE, source, REPORT_FITNESS_TAG, MPI_COMM_WORLD, &status);
-        //cout << "[master     ] receiving position." << endl;
-        MPI_Recv(&individual_position, 1, MPI_INT, source, REPORT_FITNESS_TAG, MPI_COMM_WORLD, &status);
+        pool.take_finished(finished, (number_completed == 0 && evaluating > 0) ? 1000 : 0);
 
-        int terminate_message[1];
-        terminate_message[0] = 0;
+        for (uint32_t i = 0; i < finished.size(); i++) {
+            int slot = finished[i];
 
-        cout << "terminating worker: " << source << endl;
-        MPI_Send(terminate_message, 1, MPI_INT, source, TERMINATE_TAG, MPI_COMM_WORLD);
+            queue[slot].send(0 /*master is rank 0*/, REPORT_FITNESS_TAG);
+            reported++;
+            evaluating--;
+            if (!terminating) MPI_Start(&requests[slot]);
+        }
     }
 
-    //MPI_Abort(MPI_COMM_WORLD, 0 /* success */);
+    stop_worker(queue[max_queue_size], reported, individual, requests);
 }
 
-template void master<DifferentialEvolutionMPI, double>(DifferentialEvolutionMPI *ea);
-template void master<ParticleSwarmMPI, double>(ParticleSwarmMPI *ea);
-template void master<GeneticAlgorithmMPI, int>(GeneticAlgorithmMPI *ea);
-
+/**
+ *  The worker keeps a persistent receive posted for each of its max_queue_size queue slots, so the
+ *  master's next individuals arrive while it is evaluating. MPI matches messages from the master to
+ *  the receives in the order they were started, so the slots are evaluated round robin. A separate
+ *  receive gets the terminate message, which is checked before each evaluation.
+ */
 template <typename T>
 void worker(double (*objective_function)(const std::vector<T> &),
             int number_parameters,
-            int max_queue_size
+            int max_queue_size,
+            int number_threads,
+            MPI_Comm comm
            ) {
 
+    if (number_threads > 1) {
+        threaded_worker(objective_function, number_parameters, max_queue_size, number_threads, comm);
+        return;
+    }
+
     MPI_Status status;
     int rank;
-    uint32_t individual_position;
-    T individual[number_parameters];
+    uint32_t individual_position, generation;
+    double fitness;
 
-    mpi_type_wrapper<T> parameter_type;
-    MPI_Datatype MPI_DATATYPE = parameter_type.mpi_type;
+    if (max_queue_size < 1) max_queue_size = 1;
 
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    //the last slot receives the terminate message
+    vector< IndividualMessage<T> > queue(max_queue_size + 1, IndividualMessage<T>(number_parameters, comm));
+    vector<MPI_Request> requests(max_queue_size + 1, MPI_REQUEST_NULL);
+    vector<T> individual(number_parameters, 0);
+
+    MPI_Comm_rank(comm, &rank);
+
+    for (int i = 0; i < max_queue_size; i++) {
+        queue[i].init_receive(0 /*master is rank 0*/, REQUEST_INDIVIDUALS_TAG, requests[i]);
+    }
+    queue[max_queue_size].init_receive(0 /*master is rank 0*/, TERMINATE_TAG, requests[max_queue_size]);
+    MPI_Startall(max_queue_size + 1, &requests[0]);
+
+    uint32_t reported = 0;
 
-    /**
-     *  Request enough work to fill the workers queue of individuals
-     */
     //Loop forever calculating individual fitness
+    int current = 0;
     while (true) {
         //cout << "[worker " << setw(5) << rank << "] waiting to receive individual" << endl;
 
-        MPI_Probe(0, MPI_ANY_TAG, MPI_COMM_WORLD, &status);
-        if (status.MPI_TAG == TERMINATE_TAG) {
-            int terminate_message[1];
-            MPI_Recv(terminate_message, 1, MPI_INT, 0, TERMINATE_TAG, MPI_COMM_WORLD, &status);
-            break;
-        }
-
-        MPI_Recv(individual, number_parameters, MPI_DATATYPE, 0 /*master is rank 0*/, REQUEST_INDIVIDUALS_TAG, MPI_COMM_WORLD, &status);
+        //persistent requests keep their handles when they complete, so they can be waited on from a copy
+        MPI_Request next[2] = { requests[current], requests[max_queue_size] };
+        int index;
+        MPI_Waitany(2, next, &index, &status);
+        if (index == 1) break;
 
-        //cout << "[worker " << setw(5) << rank << "] receiving individual" << endl;
-        MPI_Recv(&individual_position, 1, MPI_INT, 0 /*master is rank 0*/, REQUEST_INDIVIDUALS_TAG, MPI_COMM_WORLD, &status);
+        int terminated;
+        MPI_Test(&requests[max_queue_size], &terminated, &status);
+        if (terminated) break;
 
-        vector<T> *current_individual = new vector<T>(individual, individual + number_parameters);
+        queue[current].unpack(individual_position, generation, individual, fitness);
 
         //cout << "[worker " << setw(5) << rank << "] starting fitness calculation" << endl;
 
         //calculate the fitness of the head of the individual queue
         //double processing_start = MPI_Wtime();
-        double fitness = objective_function(*current_individual);
+        fitness = objective_function(individual);
         //double current_processing_time = MPI_Wtime() - processing_start;
 
         //cout << "[worker " << setw(5) << rank << "] calcualted fitness: " << fitness << ", in " << current_processing_time << endl;
 
-        //Send the fitness and the individual back to the master
-        //cout << "[worker " << setw(5) << rank << "] sending fitness." << endl;
-        MPI_Send(&fitness, 1, MPI_DOUBLE, 0 /*master is rank 0*/, REPORT_FITNESS_TAG, MPI_COMM_WORLD);
-
-        //cout << "[worker " << setw(5) << rank << "] sending " << number_parameters << " parameters." << endl;
-        MPI_Send(&(*current_individual)[0], number_parameters, MPI_DATATYPE, 0 /*master is rank 0 */, REPORT_FITNESS_TAG, MPI_COMM_WORLD);
+        //Send the fitness back to the master with the individual, position and generation it was assigned, then refill the slot
+        queue[current].set_fitness(fitness);
+        queue[current].send(0 /*master is rank 0*/, REPORT_FITNESS_TAG);
+        reported++;
+        MPI_Start(&requests[current]);
 
-        //cout << "[worker " << setw(5) << rank << "] sending position." << endl;
-        MPI_Send(&individual_position, 1, MPI_INT, 0 /*master is rank 0 */, REPORT_FITNESS_TAG, MPI_COMM_WORLD);
-        //cout << "[worker " << setw(5) << rank << "] sent position." << endl;
-
-        //Delete the popped individual
-        delete current_individual;
+        current = (current + 1) % max_queue_size;
     }
+
+    stop_worker(queue[max_queue_size], reported, individual, requests);
 }
 
 template void worker<double>(double (*objective_function)(const std::vector<double> &),
             int number_parameters,
-            int max_queue_size
+            int max_queue_size,
+            int number_threads,
+            MPI_Comm comm
            );
 
 template void worker<int>(double (*objective_function)(const std::vector<int> &),
             int number_parameters,
-            int max_queue_size
+            int max_queue_size,
+            int number_threads,
+            MPI_Comm comm
            );
+
+/**
+ *  The root of the two level topology keeps the global best individual. Each sub-master sends it the
+ *  best individual of its island and gets the global best back, until all of them report they are done.
+ */
+template <typename T>
+void root(uint32_t number_parameters, MPI_Comm leaders) {
+    int number_leaders;
+    MPI_Comm_size(leaders, &number_leaders);
+
+    MPI_Status status;
+    IndividualMessage<T> message(number_parameters, leaders);
+    vector<T> received(number_parameters, 0);
+    vector<T> global_best(number_parameters, 0);
+    double global_best_fitness = -std::numeric_limits<double>::max();
+
+    double start_time = MPI_Wtime();
+
+    int active = number_leaders - 1;
+    while (active > 0) {
+        message.receive(MPI_ANY_SOURCE, MIGRATION_TAG, status);
+
+        uint32_t finished, generation;
+        double fitness;
+        message.unpack(finished, generation, received, fitness);
+
+        if (fitness > global_best_fitness) {
+            global_best_fitness = fitness;
+            global_best.assign(received.begin(), received.end());
+        }
+
+        if (finished) {
+            active--;
+        } else {
+            message.pack(0, 0, global_best, global_best_fitness);
+            message.send(status.MPI_SOURCE, MIGRATION_TAG);
+        }
+    }
+
+    cout << endl;
+    cout << "[root        ] completed in " << (MPI_Wtime() - start_time) << " seconds." << endl;
+
+    cout.precision(10);
+    cout << vector_to_string(global_best) << endl;
+    cout << global_best_fitness << endl;
+}
+
+template<typename EvolutionaryAlgorithmsType, typename T>
+void master_worker(EvolutionaryAlgorithmsType *ea, double (*objective_function)(const std::vector<T> &), const MasterWorkerOptions &options) {
+    if (options.local_workers > 0) {
+        cout << "[master      ] evaluating with " << options.local_workers << " local worker threads" << endl;
+
+        unique_ptr<CheckpointWriter> checkpoints(start_checkpoints(ea, options));
+        LocalMasterTransport<T> transport(objective_function, options.local_workers, options.max_queue_size, ea->get_number_parameters());
+        unique_ptr<MasterTelemetry> telemetry(start_telemetry(transport, options, ""));
+        run_master<EvolutionaryAlgorithmsType, T>(ea, transport, options.max_queue_size, NULL, checkpoints.get(), telemetry.get(), options.straggler_percentile, options.straggler_factor);
+        return;
+    }
+
+    int rank, max_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &max_rank);
+
+    //threaded workers need enough queued to keep every thread busy
+    int queue_size = options.max_queue_size * max(1, options.worker_threads);
+
+    //every group needs a sub-master and at least one worker, and there is a root as well
+    int number_groups = 0;
+    if (options.group_size > 0) {
+        number_groups = (max_rank - 1) / max(2, options.group_size);
+
+        if (number_groups < 1 && rank == 0) {
+            cerr << "Not enough processes for groups of " << options.group_size << ", using a single master." << endl;
+        }
+    }
+
+    if (number_groups < 1) {
+        if (rank == 0) {
+            unique_ptr<CheckpointWriter> checkpoints(start_checkpoints(ea, options));
+            MPIMasterTransport<T> transport(MPI_COMM_WORLD, queue_size, ea->get_number_parameters());
+            unique_ptr<MasterTelemetry> telemetry(start_telemetry(transport, options, ""));
+            run_master<EvolutionaryAlgorithmsType, T>(ea, transport, queue_size, NULL, checkpoints.get(), telemetry.get(), options.straggler_percentile, options.straggler_factor);
+        } else {
+            worker<T>(objective_function, ea->get_number_parameters(), queue_size, options.worker_threads, MPI_COMM_WORLD);
+        }
+        return;
+    }
+
+    //the last group takes the ranks left over
+    int group = (rank == 0) ? MPI_UNDEFINED : min((rank - 1) / max(2, options.group_size), number_groups - 1);
+
+    MPI_Comm group_comm;
+    MPI_Comm_split(MPI_COMM_WORLD, group, rank, &group_comm);
+
+    int group_rank = -1;
+    if (group_comm != MPI_COMM_NULL) MPI_Comm_rank(group_comm, &group_rank);
+
+    MPI_Comm leaders;
+    MPI_Comm_split(MPI_COMM_WORLD, (rank == 0 || group_rank == 0) ? 0 : MPI_UNDEFINED, rank, &leaders);
+
+    if (rank == 0) {
+        cout << "[root        ] " << number_groups << " groups of " << options.group_size << " processes, migration interval " << options.migration_interval << endl;
+        if (!options.checkpoint_filename.empty()) cerr << "Argument '--checkpoint <file>' is not used with groups." << endl;
+        root<T>(ea->get_number_parameters(), leaders);
+    } else if (group_rank == 0) {
+        ea->seed_island(group);
+
+        Migration<T> migration(leaders, options.migration_interval, ea->get_number_parameters());
+        MPIMasterTransport<T> transport(group_comm, queue_size, ea->get_number_parameters());
+        unique_ptr<MasterTelemetry> telemetry(start_telemetry(transport, options, "_group" + to_string(group)));
+        run_master<EvolutionaryAlgorithmsType, T>(ea, transport, queue_size, &migration, NULL, telemetry.get(), options.straggler_percentile, options.straggler_factor);
+    } else {
+        worker<T>(objective_function, ea->get_number_parameters(), queue_size, options.worker_threads, group_comm);
+    }
+
+    if (leaders != MPI_COMM_NULL) MPI_Comm_free(&leaders);
+    if (group_comm != MPI_COMM_NULL) MPI_Comm_free(&group_comm);
+}
+
+template void master_worker<DifferentialEvolutionMPI, double>(DifferentialEvolutionMPI *ea, double (*objective_function)(const std::vector<double> &), const MasterWorkerOptions &options);
+template void master_worker<ParticleSwarmMPI, double>(ParticleSwarmMPI *ea, double (*objective_function)(const std::vector<double> &), const MasterWorkerOptions &options);
+template void master_worker<GeneticAlgorithmMPI, int>(GeneticAlgorithmMPI *ea, double (*objective_function)(const std::vector<int> &), const MasterWorkerOptions &options);
+template void master_worker<AsynchronousNewtonMethodMPI, double>(AsynchronousNewtonMethodMPI *ea, double (*objective_function)(const std::vector<double> &), const MasterWorkerOptions &options);
+
+
+/**
+ *  Looks like a single search to run_master, but hands out the individuals of several. The next
+ *  individual comes from the running search with the lowest pass, and each individual a search hands
+ *  out adds 1 / weight to its pass, so over time every search gets a share of the workers proportional
+ *  to its weight. Each individual is given a ticket as its position, which is used to route its result
+ *  back to the search and position it came from.
+ */
+template<typename EvolutionaryAlgorithmsType, typename T>
+class MultiSearch {
+    private:
+        vector<EvolutionaryAlgorithmsType*> searches;
+        vector<double> weights;
+        vector<double> passes;
+        vector<uint64_t> issued;
+
+        uint32_t next_ticket;
+        map< uint32_t, pair<uint32_t, uint32_t> > tickets;     //ticket -> (search, position)
+
+    public:
+        void (*print_statistics)(const std::vector<T> &);
+
+        MultiSearch(const vector<EvolutionaryAlgorithmsType*> &_searches, const vector<double> &_weights) throw (string) : searches(_searches), weights(_weights), passes(_searches.size(), 0.0), issued(_searches.size(), 0), next_ticket(0), print_statistics(NULL) {
+            if (searches.size() == 0) throw string("multi_search needs at least one search.");
+            if (weights.size() == 0) weights.assign(searches.size(), 1.0);
+            if (weights.size() != searches.size()) throw string("multi_search needs one weight for each search.");
+
+            for (uint32_t i = 0; i < searches.size(); i++) {
+                if (weights[i] <= 0.0) throw string("multi_search weights must be greater than 0.");
+                if (searches[i]->get_number_parameters() != searches[0]->get_number_parameters()) {
+                    throw string("multi_search needs every search to have the same number of parameters.");
+                }
+            }
+        }
+
+        void new_individual(uint32_t &ticket, vector<T> &parameters) {
+            uint32_t next = 0;
+            bool found = false;
+            for (uint32_t i = 0; i < searches.size(); i++) {
+                if (!searches[i]->is_running()) continue;
+                if (!found || passes[i] < passes[next]) next = i;
+                found = true;
+            }
+
+            //searches that have finished keep their pass, so one starting late does not get a burst
+            uint32_t position;
+            searches[next]->new_individual(position, parameters);
+            passes[next] += 1.0 / weights[next];
+            issued[next]++;
+
+            ticket = next_ticket++;
+            tickets[ticket] = pair<uint32_t, uint32_t>(next, position);
+        }
+
+        void insert_individual(uint32_t ticket, const vector<T> &parameters, double fitness) {
+            typename map< uint32_t, pair<uint32_t, uint32_t> >::iterator it = tickets.find(ticket);
+            if (it == tickets.end()) return;
+
+            searches[it->second.first]->insert_individual(it->second.second, parameters, fitness);
+            tickets.erase(it);
+        }
+
+        bool is_running() {
+            for (uint32_t i = 0; i < searches.size(); i++) {
+                if (searches[i]->is_running()) return true;
+            }
+            return false;
+        }
+
+        //progress is reported as the iteration the slowest running search is on
+        uint32_t get_current_iteration() {
+            uint32_t iteration = 0;
+            bool found = false;
+            for (uint32_t i = 0; i < searches.size(); i++) {
+                if (!searches[i]->is_running()) continue;
+                uint32_t search_iteration = searches[i]->get_current_iteration();
+                if (!found || search_iteration < iteration) iteration = search_iteration;
+                found = true;
+            }
+            return iteration;
+        }
+
+        uint32_t get_number_parameters() {
+            return searches[0]->get_number_parameters();
+        }
+
+        uint32_t best_search() {
+            uint32_t best = 0;
+            for (uint32_t i = 1; i < searches.size(); i++) {
+                if (searches[i]->get_global_best_fitness() > searches[best]->get_global_best_fitness()) best = i;
+            }
+            return best;
+        }
+
+        vector<T> get_global_best() {
+            return searches[best_search()]->get_global_best();
+        }
+
+        double get_global_best_fitness() {
+            return searches[best_search()]->get_global_best_fitness();
+        }
+
+        void insert_migrant(const vector<T> &individual, double fitness) {
+            for (uint32_t i = 0; i < searches.size(); i++) {
+                searches[i]->insert_migrant(individual, fitness);
+            }
+        }
+
+        void print_searches() {
+            cout.precision(10);
+            for (uint32_t i = 0; i < searches.size(); i++) {
+                cout << "[search " << setw(4) << i << " ] weight " << weights[i] << ", " << issued[i] << " individuals, iteration " << searches[i]->get_current_iteration() << ", best " << searches[i]->get_global_best_fitness() << " " << vector_to_string(searches[i]->get_global_best()) << endl;
+            }
+        }
+};
+
+template<typename EvolutionaryAlgorithmsType, typename T>
+void multi_search(const vector<EvolutionaryAlgorithmsType*> &searches, const vector<double> &weights, double (*objective_function)(const std::vector<T> &), const MasterWorkerOptions &options) throw (string) {
+    MultiSearch<EvolutionaryAlgorithmsType, T> multi(searches, weights);
+
+    if (options.local_workers > 0) {
+        cout << "[master      ] evaluating " << searches.size() << " searches with " << options.local_workers << " local worker threads" << endl;
+
+        LocalMasterTransport<T> transport(objective_function, options.local_workers, options.max_queue_size, multi.get_number_parameters());
+        unique_ptr<MasterTelemetry> telemetry(start_telemetry(transport, options, ""));
+        run_master<MultiSearch<EvolutionaryAlgorithmsType, T>, T>(&multi, transport, options.max_queue_size, NULL, NULL, telemetry.get(), options.straggler_percentile, options.straggler_factor);
+        multi.print_searches();
+        return;
+    }
+
+    int rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+
+    int queue_size = options.max_queue_size * max(1, options.worker_threads);
+
+    if (rank == 0) {
+        if (options.group_size > 0) cerr << "Searches sharing workers do not use groups, using a single master." << endl;
+
+        MPIMasterTransport<T> transport(MPI_COMM_WORLD, queue_size, multi.get_number_parameters());
+        unique_ptr<MasterTelemetry> telemetry(start_telemetry(transport, options, ""));
+        run_master<MultiSearch<EvolutionaryAlgorithmsType, T>, T>(&multi, transport, queue_size, NULL, NULL, telemetry.get(), options.straggler_percentile, options.straggler_factor);
+        multi.print_searches();
+    } else {
+        worker<T>(objective_function, multi.get_number_parameters(), queue_size, options.worker_threads, MPI_COMM_WORLD);
+    }
+}
+
+template void multi_search<DifferentialEvolutionMPI, double>(const vector<DifferentialEvolutionMPI*> &searches, const vector<double> &weights, double (*objective_function)(const std::vector<double> &), const MasterWorkerOptions &options) throw (string);
+template void multi_search<ParticleSwarmMPI, double>(const vector<ParticleSwarmMPI*> &searches, const vector<double> &weights, double (*objective_function)(const std::vector<double> &), const MasterWorkerOptions &options) throw (string);
+template void multi_search<GeneticAlgorithmMPI, int>(const vector<GeneticAlgorithmMPI*> &searches, const vector<double> &weights, double (*objective_function)(const std::vector<int> &), const MasterWorkerOptions &options) throw (string);
+template void multi_search<AsynchronousNewtonMethodMPI, double>(const vector<AsynchronousNewtonMethodMPI*> &searches, const vector<double> &weights, double (*objective_function)(const std::vector<double> &), const MasterWorkerOptions &options) throw (string);
+
+
+/**
+ *  Every rank holds a replica of the search seeded the same way, so the whole generation can be generated
+ *  on every rank and only the fitnesses need to be sent. Each rank evaluates a contiguous block of the
+ *  generation, the fitnesses are exchanged with MPI_Allgatherv and every rank inserts all of them, which
+ *  keeps the replicas identical (this needs the same binary on every node, so the floating point results
+ *  match).
+ */
+template<typename EvolutionaryAlgorithmsType>
+void generational(EvolutionaryAlgorithmsType *ea, double (*objective_function)(const std::vector<double> &), MPI_Comm comm) {
+    int rank, number_ranks;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &number_ranks);
+
+    uint32_t seed = time(0);
+    MPI_Bcast(&seed, 1, MPI_UINT32_T, 0, comm);
+    ea->seed_replica(seed);
+
+    //the replicas would repeat everything the search on rank 0 prints
+    if (rank != 0) ea->print_statistics = NULL;
+
+    uint32_t population_size = ea->get_population_size();
+    uint32_t number_parameters = ea->get_number_parameters();
+
+    vector<int> counts(number_ranks), displacements(number_ranks);
+    for (int i = 0; i < number_ranks; i++) {
+        counts[i] = (population_size / number_ranks) + ((uint32_t)i < population_size % number_ranks ? 1 : 0);
+        displacements[i] = (i == 0) ? 0 : displacements[i - 1] + counts[i - 1];
+    }
+
+    if (rank == 0) {
+        cout << "[generational] " << number_ranks << " ranks evaluating " << population_size << " individuals per generation" << endl;
+    }
+
+    vector<uint32_t> ids(population_size);
+    vector< vector<double> > generation(population_size, vector<double>(number_parameters));
+    vector<double> fitnesses(population_size);
+    vector<double> local_fitnesses(max(1, counts[rank]));
+
+    double start_time = wall_time();
+    int last_printed_iteration = -1;
+    double previous_best_fitness = -numeric_limits<double>::max();
+    int unchanged_fitnesses = 0;
+
+    int finished = 0;
+    while (!finished) {
+        for (uint32_t i = 0; i < population_size; i++) {
+            ea->new_individual(ids[i], generation[i]);
+        }
+
+        for (int i = 0; i < counts[rank]; i++) {
+            local_fitnesses[i] = objective_function(generation[displacements[rank] + i]);
+        }
+
+        MPI_Allgatherv(&local_fitnesses[0], counts[rank], MPI_DOUBLE, &fitnesses[0], &counts[0], &displacements[0], MPI_DOUBLE, comm);
+
+        for (uint32_t i = 0; i < population_size; i++) {
+            ea->insert_individual(ids[i], generation[i], fitnesses[i]);
+        }
+
+        //the replicas agree on is_running, but only rank 0 tracks whether the best fitness has stopped improving
+        if (rank == 0) finished = update_progress(ea, start_time, last_printed_iteration, previous_best_fitness, unchanged_fitnesses);
+        MPI_Bcast(&finished, 1, MPI_INT, 0, comm);
+    }
+}
+
+template void generational<DifferentialEvolutionMPI>(DifferentialEvolutionMPI *ea, double (*objective_function)(const std::vector<double> &), MPI_Comm comm);
+template void generational<ParticleSwarmMPI>(ParticleSwarmMPI *ea, double (*objective_function)(const std::vector<double> &), MPI_Comm comm);
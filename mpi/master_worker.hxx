@@ -1,22 +1,99 @@
 #ifndef TAO_MPI_MASTER_WORKER_H
 #define TAO_MPI_MASTER_WORKER_H
 
+#include <string>
 #include <vector>
 
+#include "stdint.h"
+
+#include "mpi.h"
+
+using std::string;
 using std::vector;
 
 #define REQUEST_INDIVIDUALS_TAG 0
 #define REPORT_FITNESS_TAG 1000
 #define TERMINATE_TAG 2000
+#define MIGRATION_TAG 4000
 
+/**
+ *  Arguments:
+ *      --max_queue_size <i>        individuals queued on each worker (default 3), per thread with --worker_threads
+ *      --worker_threads <i>        threads evaluating individuals on each worker rank, 0 uses all cores (default 1,
+ *                                  the objective function must be thread safe to use more)
+ *      --straggler_percentile <f>  re-issue individuals that have been outstanding longer than --straggler_factor times
+ *                                  this percentile (0 to 1) of recent evaluation latencies to the next worker that
+ *                                  reports a result, the first result to come back is used (default 0, disabled)
+ *      --straggler_factor <f>      (default 2)
+ *      --group_size <i>            use a two level topology: rank 0 is the root, and the other ranks are split into
+ *                                  groups of this many, each with a sub-master running its own island of the search
+ *                                  (default 0, a single master)
+ *      --migration_interval <i>    results a sub-master processes between exchanging its best individual with the
+ *                                  global best held by the root (default 1000)
+ *      --generational              particle swarm and differential evolution with more than one MPI process only: run
+ *                                  synchronous generations with collectives instead of the asynchronous master and
+ *                                  workers, for homogeneous clusters
+ *      --local_workers <i>         without MPI, or with a single MPI process, the search runs in this process with this
+ *                                  many worker threads, 0 uses all cores (default 1, the objective function must be
+ *                                  thread safe to use more)
+ *      --checkpoint <file>         particle swarm and differential evolution without groups only: the master writes the
+ *                                  search to this file periodically and when it finishes, and the search resumes from
+ *                                  it if it exists
+ *      --checkpoint_interval <i>   seconds between checkpoints (default 300)
+ *      --telemetry <file>          the master writes the results, bytes and latencies of each worker and how long it
+ *                                  waited for results to this file periodically, as CSV if the file ends in .csv
+ *                                  and JSON (an object per line) otherwise; sub-masters add _group<i> to the name
+ *      --telemetry_interval <i>    seconds between writes to the telemetry file (default 10)
+ */
+struct MasterWorkerOptions {
+    int max_queue_size;
+    int worker_threads;
+    double straggler_percentile;
+    double straggler_factor;
+    int group_size;
+    int migration_interval;
+    bool generational;
+    int local_workers;
+    string checkpoint_filename;
+    uint32_t checkpoint_interval;
+    string telemetry_filename;
+    uint32_t telemetry_interval;
+
+    MasterWorkerOptions(const vector<string> &arguments);
+};
 
 template<typename EvolutionaryAlgorithmsType, typename T>
-void master(EvolutionaryAlgorithmsType *ea);
+void master(EvolutionaryAlgorithmsType *ea, int max_queue_size, MPI_Comm comm = MPI_COMM_WORLD);
 
 template<typename T>
 void worker(double (*objective_function)(const std::vector<T> &),
             int number_parameters,
-            int max_queue_size);
+            int max_queue_size,
+            int number_threads = 1,
+            MPI_Comm comm = MPI_COMM_WORLD);
+
+/**
+ *  Runs the search over MPI_COMM_WORLD with the topology given by the options, every rank must call this.
+ *  If there is only one process (or MPI was never initialized) the workers are threads of this process.
+ */
+template<typename EvolutionaryAlgorithmsType, typename T>
+void master_worker(EvolutionaryAlgorithmsType *ea, double (*objective_function)(const std::vector<T> &), const MasterWorkerOptions &options);
+
+/**
+ *  Runs several searches over one pool of workers, every rank must call this (the searches are only used
+ *  on rank 0). Workers are shared between the running searches in proportion to their weights (equal if
+ *  weights is empty), and a search that finishes leaves its share to the others. The searches share the
+ *  objective function and must have the same number of parameters.
+ */
+template<typename EvolutionaryAlgorithmsType, typename T>
+void multi_search(const vector<EvolutionaryAlgorithmsType*> &searches, const vector<double> &weights, double (*objective_function)(const std::vector<T> &), const MasterWorkerOptions &options) throw (string);
+
+/**
+ *  Runs a synchronous generational search over comm, every rank must call this. Every rank evaluates an
+ *  equal share of each generation, the search needs a seed_replica(uint32_t) method.
+ */
+template<typename EvolutionaryAlgorithmsType>
+void generational(EvolutionaryAlgorithmsType *ea, double (*objective_function)(const std::vector<double> &), MPI_Comm comm = MPI_COMM_WORLD);
 
 template<typename T>
 void set_print_statistics(double (*_print_statistics)(const std::vector<T> &));
@@ -0,0 +1,104 @@
+#include <vector>
+#include <iostream>
+#include <random>
+
+#include <ctime>
+
+#include "mpi.h"
+
+#include "asynchronous_algorithms/asynchronous_newton_method.hxx"
+
+#include "mpi/master_worker.hxx"
+#include "mpi/mpi_asynchronous_newton_method.hxx"
+
+#include "util/recombination.hxx"
+
+using namespace std;
+
+AsynchronousNewtonMethodMPI::AsynchronousNewtonMethodMPI(const vector<double> &min_bound,
+                                                         const vector<double> &max_bound,
+                                                         const vector<double> &regression_radius,
+                                                         const vector<string> &arguments
+                                                        ) throw (string) : AsynchronousNewtonMethod(min_bound, max_bound, regression_radius, arguments), options(arguments), pending_iteration(0), next_pending(0), print_statistics(NULL) {
+}
+
+AsynchronousNewtonMethodMPI::AsynchronousNewtonMethodMPI(const vector<double> &min_bound,
+                                                         const vector<double> &max_bound,
+                                                         const vector<double> &center,
+                                                         const vector<double> &regression_radius,
+                                                         const vector<string> &arguments
+                                                        ) throw (string) : AsynchronousNewtonMethod(min_bound, max_bound, center, regression_radius, arguments), options(arguments), pending_iteration(0), next_pending(0), print_statistics(NULL) {
+}
+
+void AsynchronousNewtonMethodMPI::go(double (*objective_function)(const std::vector<double> &)) {
+    master_worker<AsynchronousNewtonMethodMPI, double>(this, objective_function, options);
+}
+
+bool AsynchronousNewtonMethodMPI::phase_finished() {
+    if (current_iteration % 2 == 0) return regression_individuals_reported >= minimum_regression_individuals;
+    else return line_search_individuals_reported >= minimum_line_search_individuals;
+}
+
+void AsynchronousNewtonMethodMPI::new_individual(uint32_t &iteration, vector<double> &parameters) throw (string) {
+    /**
+     *  generate_individuals starts the next phase once the current one has enough results, so it is
+     *  called as soon as that happens, rather than sending out what is left of the finished phase
+     */
+    if (!first_workunits_generated || phase_finished() || next_pending >= pending.size() || (pending_iteration & ~SPECULATIVE) < current_iteration) {
+        uint32_t number_individuals;
+
+        if (generate_individuals(number_individuals, pending_iteration, pending) && pending.size() > 0) {
+            next_pending = 0;
+        } else if (next_pending >= pending.size() || (pending_iteration & ~SPECULATIVE) < current_iteration) {
+            //the phase is waiting on results that are already out, so give this worker another individual for it
+            pending_iteration = current_iteration;
+            pending.resize(1, vector<double>(number_parameters));
+            next_pending = 0;
+
+            if (current_iteration % 2 == 0) {
+                Recombination::random_around(center, regression_radius, pending[0], random_number_generator, random_0_1);
+            } else {
+                Recombination::random_along(center, line_search_direction, line_search_min, line_search_max, pending[0], random_number_generator, random_0_1);
+            }
+            Recombination::bound_parameters(min_bound, max_bound, pending[0]);
+        }
+    }
+
+    iteration = pending_iteration;
+    parameters = pending[next_pending];
+    next_pending++;
+}
+
+bool AsynchronousNewtonMethodMPI::is_running() {
+    if (maximum_iterations > 0 && current_iteration >= maximum_iterations) return false;
+    if (max_failed_improvements > 0 && failed_improvements >= max_failed_improvements) return false;
+    return true;
+}
+
+uint32_t AsynchronousNewtonMethodMPI::get_current_iteration() {
+    return current_iteration;
+}
+
+uint32_t AsynchronousNewtonMethodMPI::get_number_parameters() {
+    return number_parameters;
+}
+
+vector<double> AsynchronousNewtonMethodMPI::get_global_best() {
+    return center;
+}
+
+double AsynchronousNewtonMethodMPI::get_global_best_fitness() {
+    return center_fitness;
+}
+
+void AsynchronousNewtonMethodMPI::insert_migrant(const vector<double> &individual, double fitness) {
+    if (fitness > center_fitness) {
+        center.assign(individual.begin(), individual.end());
+        center_fitness = fitness;
+    }
+}
+
+void AsynchronousNewtonMethodMPI::seed_island(uint32_t island) {
+    seed_seq seed = {(uint32_t)time(0), island};
+    random_number_generator.seed(seed);
+}
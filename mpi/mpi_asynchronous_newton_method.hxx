@@ -0,0 +1,65 @@
+#ifndef TAO_MPI_ASYNCHRONOUS_NEWTON_METHOD_H
+#define TAO_MPI_ASYNCHRONOUS_NEWTON_METHOD_H
+
+#include <vector>
+
+#include "asynchronous_algorithms/asynchronous_newton_method.hxx"
+
+#include "mpi/master_worker.hxx"
+
+using std::vector;
+
+/**
+ *  Runs the asynchronous newton method with master_worker. Each phase's individuals are streamed to the
+ *  workers as they ask for more, and the phase ends once its minimum number of results has come back;
+ *  the extra_workunits individuals still out on slow workers are ignored when they report, since their
+ *  iteration has finished. If a phase has been completely sent out but is still waiting on results,
+ *  the workers are given more individuals for it, which are also only used until the phase has all the
+ *  results it can take.
+ */
+class AsynchronousNewtonMethodMPI : public AsynchronousNewtonMethod {
+    private:
+        MasterWorkerOptions options;
+
+        //individuals generated for a phase that have not been sent to a worker yet
+        uint32_t pending_iteration;
+        uint32_t next_pending;
+        vector< vector<double> > pending;
+
+        bool phase_finished();
+
+    public:
+        void (*print_statistics)(const std::vector<double> &);
+
+        AsynchronousNewtonMethodMPI(const vector<double> &min_bound,          /* min bound is copied into the search */
+                                    const vector<double> &max_bound,          /* max bound is copied into the search */
+                                    const vector<double> &regression_radius,
+                                    const vector<string> &arguments
+                                   ) throw (string);
+
+        AsynchronousNewtonMethodMPI(const vector<double> &min_bound,          /* min bound is copied into the search */
+                                    const vector<double> &max_bound,          /* max bound is copied into the search */
+                                    const vector<double> &center,
+                                    const vector<double> &regression_radius,
+                                    const vector<string> &arguments
+                                   ) throw (string);
+
+        void go(double (*objective_function)(const std::vector<double> &));
+
+        //the interface used by master_worker, the position of an individual is its iteration
+        void new_individual(uint32_t &iteration, vector<double> &parameters) throw (string);
+
+        bool is_running();
+        uint32_t get_current_iteration();
+        uint32_t get_number_parameters();
+        vector<double> get_global_best();
+        double get_global_best_fitness();
+
+        //a migrant better than the center becomes the center for the next regression
+        void insert_migrant(const vector<double> &individual, double fitness);
+
+        //reseeds the random number generator, so islands started at the same time differ
+        void seed_island(uint32_t island);
+};
+
+#endif
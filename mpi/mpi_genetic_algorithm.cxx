@@ -2,6 +2,9 @@
 #include <iostream>
 #include <iomanip>
 #include <queue>
+#include <random>
+
+#include <ctime>
 
 #include "mpi.h"
 
@@ -18,30 +21,24 @@ GeneticAlgorithmMPI::GeneticAlgorithmMPI(const vector<string> &arguments,
                                          int encoding_length,
                                          random_encoding_type random_encoding,
                                          mutate_type mutate,
-                                         crossover_type crossover) : GeneticAlgorithm(arguments, encoding_length, random_encoding, mutate, crossover) {
-
-    int rank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-
-    if (!get_argument(arguments, "--max_queue_size", false, max_queue_size)) {
-        if (rank == 0) {
-            cout << "Argument '--max_queue_size <I>' not found, using default of 3." << endl;
-        }
-        max_queue_size = 3;
-    }
+                                         crossover_type crossover) : GeneticAlgorithm(arguments, encoding_length, random_encoding, mutate, crossover), options(arguments) {
 }
 
 
 void GeneticAlgorithmMPI::go(objective_function_type objective_function) {
-    int rank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    master_worker<GeneticAlgorithmMPI, int>(this, objective_function, options);
 
-    if (rank == 0) {
-        master<GeneticAlgorithmMPI, int>(this);
-    } else {
-        worker<int>(objective_function, encoding_length, max_queue_size);
-    }
+    int initialized;
+    MPI_Initialized(&initialized);
+    if (initialized) MPI_Finalize();
+}
 
-    MPI_Finalize();
+void GeneticAlgorithmMPI::insert_migrant(const vector<int> &individual, double fitness) {
+    //the genetic algorithm ignores the position, the individual is placed by its fitness
+    insert_individual(0, individual, fitness);
 }
 
+void GeneticAlgorithmMPI::seed_island(uint32_t island) {
+    seed_seq seed = {(uint32_t)time(0), island};
+    random_number_generator.seed(seed);
+}
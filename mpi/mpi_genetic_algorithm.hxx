@@ -5,11 +5,13 @@
 
 #include "asynchronous_algorithms/asynchronous_genetic_search.hxx"
 
+#include "mpi/master_worker.hxx"
+
 using std::vector;
 
 class GeneticAlgorithmMPI : public GeneticAlgorithm {
     private:
-        int max_queue_size;
+        MasterWorkerOptions options;
     public:
         GeneticAlgorithmMPI(const vector<string> &arguments,
                             int encoding_length,
@@ -18,6 +20,12 @@ class GeneticAlgorithmMPI : public GeneticAlgorithm {
                             crossover_type crossover);
 
         void go(objective_function_type objective_function);
+
+        //inserts an individual from another island of the search
+        void insert_migrant(const vector<int> &individual, double fitness);
+
+        //reseeds the random number generator, so islands started at the same time differ
+        void seed_island(uint32_t island);
 };
 
 #endif
@@ -0,0 +1,231 @@
+#include <algorithm>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include "mpi.h"
+
+#include "stdint.h"
+
+#include "mpi/mpi_parameter_sweep.hxx"
+
+#include "synchronous_algorithms/parameter_sweep.hxx"
+
+#include "util/arguments.hxx"
+
+using namespace std;
+
+/**
+ *  A request from a worker holds the range it just finished, how long it took and the best points found in it:
+ *      uint64_t first, uint64_t last, double seconds, uint32_t number_results, (uint64_t index, double fitness) * number_results
+ */
+static void pack_request(uint64_t first, uint64_t last, double seconds, const SweepResults &results, vector<char> &buffer) {
+    const vector<SweepResult> &kept = results.get_results();
+    uint32_t number_results = kept.size();
+
+    buffer.resize((2 * sizeof(uint64_t)) + sizeof(double) + sizeof(uint32_t) + (number_results * (sizeof(uint64_t) + sizeof(double))));
+
+    char *position = &buffer[0];
+    memcpy(position, &first, sizeof(uint64_t));             position += sizeof(uint64_t);
+    memcpy(position, &last, sizeof(uint64_t));              position += sizeof(uint64_t);
+    memcpy(position, &seconds, sizeof(double));             position += sizeof(double);
+    memcpy(position, &number_results, sizeof(uint32_t));    position += sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < number_results; i++) {
+        memcpy(position, &kept[i].index, sizeof(uint64_t));     position += sizeof(uint64_t);
+        memcpy(position, &kept[i].fitness, sizeof(double));     position += sizeof(double);
+    }
+}
+
+static void unpack_request(const vector<char> &buffer, uint64_t &first, uint64_t &last, double &seconds, SweepResults &results) {
+    uint32_t number_results;
+
+    const char *position = &buffer[0];
+    memcpy(&first, position, sizeof(uint64_t));             position += sizeof(uint64_t);
+    memcpy(&last, position, sizeof(uint64_t));              position += sizeof(uint64_t);
+    memcpy(&seconds, position, sizeof(double));             position += sizeof(double);
+    memcpy(&number_results, position, sizeof(uint32_t));    position += sizeof(uint32_t);
+
+    for (uint32_t i = 0; i < number_results; i++) {
+        uint64_t index;
+        double fitness;
+        memcpy(&index, position, sizeof(uint64_t));     position += sizeof(uint64_t);
+        memcpy(&fitness, position, sizeof(double));     position += sizeof(double);
+
+        results.insert(index, fitness);
+    }
+}
+
+static uint64_t remaining_evaluations(const deque< pair<uint64_t, uint64_t> > &ranges) {
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < ranges.size(); i++) total += ranges[i].second - ranges[i].first;
+    return total;
+}
+
+static void sweep_master(const vector<string> &arguments, const SweepGrid &grid, uint32_t k, int number_workers) {
+    double chunk_seconds = 10.0;
+    if (!get_argument(arguments, "--sweep_chunk_seconds", false, chunk_seconds)) {
+        cerr << "Argument '--sweep_chunk_seconds <f>' not found, using default of " << chunk_seconds << "." << endl;
+    }
+
+    string checkpoint_filename;
+    uint32_t checkpoint_interval = 300;
+    if (get_argument(arguments, "--sweep_checkpoint", false, checkpoint_filename)) {
+        if (!get_argument(arguments, "--sweep_checkpoint_interval", false, checkpoint_interval)) {
+            cerr << "Argument '--sweep_checkpoint_interval <i>' not found, using default of " << checkpoint_interval << " seconds." << endl;
+        }
+    }
+
+    SweepResults results(k);
+    vector< pair<uint64_t, uint64_t> > initial_ranges;
+    if (!checkpoint_filename.empty() && read_sweep_checkpoint(checkpoint_filename, grid, initial_ranges, results)) {
+        cout << "resuming from checkpoint '" << checkpoint_filename << "'." << endl;
+    } else {
+        initial_ranges.push_back(pair<uint64_t, uint64_t>(0, grid.size()));
+    }
+    deque< pair<uint64_t, uint64_t> > ranges(initial_ranges.begin(), initial_ranges.end());
+
+    cout << "expected evaluations: " << remaining_evaluations(ranges) << endl;
+
+    //the range each worker is evaluating, and its average seconds per evaluation (0 until it has reported)
+    vector< pair<uint64_t, uint64_t> > assigned(number_workers + 1, pair<uint64_t, uint64_t>(0, 0));
+    vector<double> seconds_per_evaluation(number_workers + 1, 0.0);
+
+    uint64_t evaluations = 0;
+    int active_workers = number_workers;
+    double start_time = MPI_Wtime();
+    double last_checkpoint = start_time;
+
+    MPI_Status status;
+    vector<char> buffer;
+    uint64_t assignment[2];
+
+    while (active_workers > 0) {
+        MPI_Probe(MPI_ANY_SOURCE, SWEEP_REQUEST_TAG, MPI_COMM_WORLD, &status);
+        int source = status.MPI_SOURCE;
+
+        int size;
+        MPI_Get_count(&status, MPI_BYTE, &size);
+        buffer.resize(size);
+        MPI_Recv(&buffer[0], size, MPI_BYTE, source, SWEEP_REQUEST_TAG, MPI_COMM_WORLD, &status);
+
+        uint64_t first, last;
+        double seconds;
+        unpack_request(buffer, first, last, seconds, results);
+
+        if (last > first) {
+            evaluations += last - first;
+
+            double measured = seconds / (last - first);
+            if (seconds_per_evaluation[source] == 0.0) seconds_per_evaluation[source] = measured;
+            else seconds_per_evaluation[source] = 0.5 * (seconds_per_evaluation[source] + measured);
+        }
+        assigned[source] = pair<uint64_t, uint64_t>(0, 0);
+
+        if (ranges.empty()) {
+            assignment[0] = 0;
+            assignment[1] = 0;
+            MPI_Send(assignment, 2, MPI_UINT64_T, source, SWEEP_ASSIGNMENT_TAG, MPI_COMM_WORLD);
+            active_workers--;
+        } else {
+            //workers that have not reported yet get a single evaluation so their speed can be measured
+            uint64_t chunk_size = 1;
+            if (seconds_per_evaluation[source] > 0.0) {
+                chunk_size = max((uint64_t)1, (uint64_t)(chunk_seconds / seconds_per_evaluation[source]));
+            }
+
+            //guided scheduling: never hand out more than a share of what is left, so the workers finish together
+            uint64_t share = max((uint64_t)1, remaining_evaluations(ranges) / (2 * number_workers));
+            chunk_size = min(chunk_size, share);
+
+            pair<uint64_t, uint64_t> &range = ranges.front();
+            assignment[0] = range.first;
+            assignment[1] = min(range.second, range.first + chunk_size);
+            range.first = assignment[1];
+            if (range.first == range.second) ranges.pop_front();
+
+            assigned[source] = pair<uint64_t, uint64_t>(assignment[0], assignment[1]);
+            MPI_Send(assignment, 2, MPI_UINT64_T, source, SWEEP_ASSIGNMENT_TAG, MPI_COMM_WORLD);
+        }
+
+        double now = MPI_Wtime();
+        if (!checkpoint_filename.empty() && (active_workers == 0 || (checkpoint_interval > 0 && now - last_checkpoint >= checkpoint_interval))) {
+            vector< pair<uint64_t, uint64_t> > remaining(ranges.begin(), ranges.end());
+            for (int i = 1; i <= number_workers; i++) {
+                if (assigned[i].second > assigned[i].first) remaining.push_back(assigned[i]);
+            }
+            sort(remaining.begin(), remaining.end());
+
+            try {
+                write_sweep_checkpoint(checkpoint_filename, grid, remaining, results);
+            } catch (string err_msg) {
+                cerr << "parameter sweep could not write checkpoint: " << err_msg << endl;
+            }
+            last_checkpoint = now;
+        }
+    }
+
+    print_sweep_results(grid, results);
+    cout << "total    evaluations: " << evaluations << endl;
+    cout << "elapsed  seconds:     " << (MPI_Wtime() - start_time) << endl;
+}
+
+static void sweep_worker(const vector<string> &arguments, const SweepGrid &grid, uint32_t k, double (*objective_function)(const std::vector<double> &)) {
+    uint32_t number_threads = 1;
+    get_argument(arguments, "--sweep_threads", false, number_threads);
+    if (number_threads == 0) number_threads = max(1u, thread::hardware_concurrency());
+
+    MPI_Status status;
+    vector<char> buffer;
+    uint64_t assignment[2] = {0, 0};
+    double seconds = 0.0;
+
+    SweepResults range_results(k);
+
+    while (true) {
+        pack_request(assignment[0], assignment[1], seconds, range_results, buffer);
+        MPI_Send(&buffer[0], buffer.size(), MPI_BYTE, 0, SWEEP_REQUEST_TAG, MPI_COMM_WORLD);
+
+        MPI_Recv(assignment, 2, MPI_UINT64_T, 0, SWEEP_ASSIGNMENT_TAG, MPI_COMM_WORLD, &status);
+        if (assignment[1] == assignment[0]) break;
+
+        double start_time = MPI_Wtime();
+
+        range_results = SweepResults(k);
+        vector< pair<uint64_t, uint64_t> > ranges(1, pair<uint64_t, uint64_t>(assignment[0], assignment[1]));
+        uint64_t chunk_size = max((uint64_t)1, (assignment[1] - assignment[0]) / (number_threads * 16));
+
+        parameter_sweep(grid, objective_function, ranges, number_threads, chunk_size, range_results, "", 0);
+
+        seconds = MPI_Wtime() - start_time;
+    }
+}
+
+void mpi_parameter_sweep(const vector<string> &arguments, const std::vector<double> &min_bound, const std::vector<double> &max_bound, const std::vector<double> &step_size, double (*objective_function)(const std::vector<double> &)) {
+    int rank, max_rank;
+    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    MPI_Comm_size(MPI_COMM_WORLD, &max_rank);
+
+    if (max_rank < 2) {
+        if (rank == 0) cerr << "mpi_parameter_sweep needs at least 2 processes, running parameter_sweep instead." << endl;
+        parameter_sweep(arguments, min_bound, max_bound, step_size, objective_function);
+        return;
+    }
+
+    SweepGrid grid(min_bound, max_bound, step_size);
+
+    uint32_t k = 10;
+    if (!get_argument(arguments, "--sweep_best", false, k) && rank == 0) {
+        cerr << "Argument '--sweep_best <i>' not found, using default of " << k << "." << endl;
+    }
+
+    if (rank == 0) {
+        cout.precision(15);
+        sweep_master(arguments, grid, k, max_rank - 1);
+    } else {
+        sweep_worker(arguments, grid, k, objective_function);
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef TAO_MPI_PARAMETER_SWEEP_H
+#define TAO_MPI_PARAMETER_SWEEP_H
+
+#include <string>
+#include <vector>
+
+using std::string;
+using std::vector;
+
+#define SWEEP_REQUEST_TAG 3000
+#define SWEEP_ASSIGNMENT_TAG 3001
+
+/**
+ *  Distributed version of parameter_sweep. The master (rank 0) hands out ranges of grid indices to the
+ *  workers as they request them, sizing each range so it takes the worker about --sweep_chunk_seconds
+ *  (default 10) based on its measured evaluation time, and shrinking them towards the end of the sweep so
+ *  the workers finish together. Workers evaluate their ranges with parameter_sweep (so --sweep_threads
+ *  applies to each worker) and send the best --sweep_best points of each range back with their next
+ *  request, which the master merges into the overall best points.
+ *
+ *  --sweep_checkpoint and --sweep_checkpoint_interval work as in parameter_sweep, with the master writing
+ *  the checkpoint (ranges still being evaluated by the workers are written as remaining).
+ */
+void mpi_parameter_sweep(const vector<string> &arguments, const std::vector<double> &min_bound, const std::vector<double> &max_bound, const std::vector<double> &step_size, double (*objective_function)(const std::vector<double> &));
+
+#endif
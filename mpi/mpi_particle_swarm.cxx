@@ -2,11 +2,16 @@
 #include <iostream>
 #include <iomanip>
 #include <queue>
+#include <random>
+#include <sstream>
+
+#include <ctime>
 
 #include "mpi.h"
 
 #include "asynchronous_algorithms/particle_swarm.hxx"
 
+#include "mpi/checkpoint.hxx"
 #include "mpi/master_worker.hxx"
 #include "mpi/mpi_particle_swarm.hxx"
 
@@ -21,33 +26,84 @@ using namespace std;
 ParticleSwarmMPI::ParticleSwarmMPI(const std::vector<double> &min_bound,            /* min bound is copied into the search */
                                    const std::vector<double> &max_bound,            /* max bound is copied into the search */
                                    const vector<string> &arguments
-                                  ) : ParticleSwarm(min_bound, max_bound, arguments) {
-
-    int rank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
-
-    if (!get_argument(arguments, "--max_queue_size", false, max_queue_size)) {
-        if (rank == 0) {
-            cout << "Argument '--max_queue_size <I>' not found, using default of 3." << endl;
-        }
-        max_queue_size = 3;
-    }
+                                  ) : ParticleSwarm(min_bound, max_bound, arguments), options(arguments) {
 }
 
 
 void ParticleSwarmMPI::go(double (*objective_function)(const std::vector<double> &)) {
-    int rank;
-    MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+    if (options.generational && options.local_workers == 0) {
+        int rank;
+        MPI_Comm_rank(MPI_COMM_WORLD, &rank);
+        if (rank != 0) quiet = true;
 
-    if (rank == 0) {
-        master<ParticleSwarmMPI, double>(this);
+        generational<ParticleSwarmMPI>(this, objective_function);
     } else {
-        worker(objective_function, this->number_parameters, max_queue_size);
+        master_worker<ParticleSwarmMPI, double>(this, objective_function, options);
     }
     
 //    MPI_Finalize();
 }
 
+void ParticleSwarmMPI::insert_migrant(const vector<double> &individual, double fitness) {
+    //replaces a random member of the population if it is better
+    uint32_t position = random_0_1(random_number_generator) * population_size;
+    insert_individual(position, individual, fitness);
+}
+
+void ParticleSwarmMPI::seed_island(uint32_t island) {
+    seed_seq seed = {(uint32_t)time(0), island};
+    random_number_generator.seed(seed);
+}
+
+void ParticleSwarmMPI::seed_replica(uint32_t seed) {
+    random_number_generator.seed(seed);
+}
+
+void ParticleSwarmMPI::write_checkpoint(Checkpoint &checkpoint) {
+    checkpoint.write(number_parameters);
+    checkpoint.write(population_size);
+
+    checkpoint.write(current_iteration);
+    checkpoint.write(current_individual);
+    checkpoint.write(individuals_created);
+    checkpoint.write(individuals_reported);
+    checkpoint.write_generator(random_number_generator);
+
+    checkpoint.write(initialized_individuals);
+    checkpoint.write_vectors(particles);
+    checkpoint.write_vectors(velocities);
+    checkpoint.write_vectors(local_bests);
+    checkpoint.write_vector(local_best_fitnesses);
+    checkpoint.write_vector(global_best);
+    checkpoint.write(global_best_fitness);
+}
+
+void ParticleSwarmMPI::read_checkpoint(Checkpoint &checkpoint) throw (string) {
+    uint32_t checkpoint_parameters, checkpoint_population_size;
+    checkpoint.read(checkpoint_parameters);
+    checkpoint.read(checkpoint_population_size);
+
+    if (checkpoint_parameters != number_parameters || checkpoint_population_size != population_size) {
+        ostringstream err_msg;
+        err_msg << "checkpoint has " << checkpoint_parameters << " parameters and a population of " << checkpoint_population_size << ", the search has " << number_parameters << " and " << population_size << ".";
+        throw err_msg.str();
+    }
+
+    checkpoint.read(current_iteration);
+    checkpoint.read(current_individual);
+    checkpoint.read(individuals_created);
+    checkpoint.read(individuals_reported);
+    checkpoint.read_generator(random_number_generator);
+
+    checkpoint.read(initialized_individuals);
+    checkpoint.read_vectors(particles);
+    checkpoint.read_vectors(velocities);
+    checkpoint.read_vectors(local_bests);
+    checkpoint.read_vector(local_best_fitnesses);
+    checkpoint.read_vector(global_best);
+    checkpoint.read(global_best_fitness);
+}
+
 #ifdef CUDA
 void ParticleSwarmMPI::go(double (*cpu_objective_function)(const std::vector<double> &),
                           double (*gpu_objective_function)(const std::vector<double> &),
@@ -56,13 +112,13 @@ void ParticleSwarmMPI::go(double (*cpu_objective_function)(const std::vector<dou
     MPI_Comm_rank(MPI_COMM_WORLD, &rank);
 
     if (rank == 0) {
-        master<ParticleSwarmMPI, double>(this);
+        master<ParticleSwarmMPI, double>(this, options.max_queue_size);
     } else {
         assign_device(rank, device_assignments[rank]);
         if (device_assignments[rank] < 0) { //-1 is for CPU, 0 .. n are for GPUs
-            worker(cpu_objective_function, this->number_parameters, max_queue_size);
+            worker(cpu_objective_function, this->number_parameters, options.max_queue_size);
         } else {
-            worker(gpu_objective_function, this->number_parameters, max_queue_size);
+            worker(gpu_objective_function, this->number_parameters, options.max_queue_size);
         }
     }
     
@@ -5,11 +5,14 @@
 
 #include "asynchronous_algorithms/particle_swarm.hxx"
 
+#include "mpi/checkpoint.hxx"
+#include "mpi/master_worker.hxx"
+
 using std::vector;
 
 class ParticleSwarmMPI : public ParticleSwarm {
     private:
-        int max_queue_size;
+        MasterWorkerOptions options;
 
     public:
         ParticleSwarmMPI(const std::vector<double> &min_bound,      /* min bound is copied into the search */
@@ -19,6 +22,19 @@ class ParticleSwarmMPI : public ParticleSwarm {
 
         void go(double (*objective_function)(const std::vector<double> &));
 
+        //inserts an individual from another island of the search
+        void insert_migrant(const vector<double> &individual, double fitness);
+
+        //reseeds the random number generator, so islands started at the same time differ
+        void seed_island(uint32_t island);
+
+        //seeds the random number generator, so every rank of a generational search makes the same individuals
+        void seed_replica(uint32_t seed);
+
+        //the state of the search, for resuming it after the run is stopped
+        void write_checkpoint(Checkpoint &checkpoint);
+        void read_checkpoint(Checkpoint &checkpoint) throw (string);
+
 #ifdef CUDA
         void go(double (*cpu_objective_function)(const std::vector<double> &),
                 double (*gpu_objective_function)(const std::vector<double> &),
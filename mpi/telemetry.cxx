@@ -0,0 +1,117 @@
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <string>
+#include <vector>
+
+#include "mpi/telemetry.hxx"
+
+using namespace std;
+
+static double telemetry_time() {
+    return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+MasterTelemetry::MasterTelemetry(const string &filename, uint32_t _interval, int number_workers, uint64_t _message_size) throw (string) : interval(_interval), message_size(_message_size), workers(number_workers) {
+    file.open(filename.c_str(), ofstream::out | ofstream::trunc);
+    if (!file.is_open()) throw string("could not open telemetry file '" + filename + "' for writing.");
+
+    csv = filename.size() >= 4 && filename.compare(filename.size() - 4, 4, ".csv") == 0;
+    if (csv) {
+        file << "time,interval,worker,results,stale,bytes_sent,bytes_received,mean_latency,master_idle,master_batches,master_mean_batch,master_max_batch,outstanding";
+        for (uint32_t i = 0; i < LATENCY_BUCKETS; i++) file << ",latency_us_" << (1ull << i);
+        file << endl;
+    }
+    file.precision(6);
+
+    start_time = telemetry_time();
+    last_write = start_time;
+    reset();
+}
+
+void MasterTelemetry::reset() {
+    for (uint32_t i = 0; i < workers.size(); i++) {
+        workers[i].results = 0;
+        workers[i].stale = 0;
+        workers[i].bytes_sent = 0;
+        workers[i].bytes_received = 0;
+        workers[i].latencies = 0;
+        workers[i].latency_sum = 0.0;
+        workers[i].latency_histogram.assign(LATENCY_BUCKETS, 0);
+    }
+
+    batches = 0;
+    batch_results = 0;
+    max_batch = 0;
+    idle_time = 0.0;
+}
+
+void MasterTelemetry::received(int worker, double latency, bool stale) {
+    WorkerTelemetry &telemetry = workers[worker];
+
+    telemetry.results++;
+    telemetry.bytes_received += message_size;
+    if (stale) telemetry.stale++;
+
+    if (latency >= 0.0) {
+        telemetry.latencies++;
+        telemetry.latency_sum += latency;
+
+        double microseconds = latency * 1000000.0;
+        int bucket = (microseconds < 2.0) ? 0 : (int)log2(microseconds);
+        if (bucket >= (int)LATENCY_BUCKETS) bucket = LATENCY_BUCKETS - 1;
+        telemetry.latency_histogram[bucket]++;
+    }
+}
+
+void MasterTelemetry::write(uint64_t outstanding, bool force) {
+    double now = telemetry_time();
+    if (!force && now - last_write < interval) return;
+
+    if (csv) write_csv(now, outstanding);
+    else write_json(now, outstanding);
+    file.flush();
+
+    last_write = now;
+    reset();
+}
+
+void MasterTelemetry::write_json(double now, uint64_t outstanding) {
+    file << "{\"time\": " << (now - start_time) << ", \"interval\": " << (now - last_write)
+         << ", \"master\": {\"idle\": " << idle_time << ", \"batches\": " << batches
+         << ", \"mean_batch\": " << (batches > 0 ? (double)batch_results / batches : 0.0)
+         << ", \"max_batch\": " << max_batch << ", \"outstanding\": " << outstanding << "}, \"workers\": [";
+
+    for (uint32_t i = 0; i < workers.size(); i++) {
+        const WorkerTelemetry &telemetry = workers[i];
+
+        if (i > 0) file << ", ";
+        file << "{\"worker\": " << (i + 1) << ", \"results\": " << telemetry.results << ", \"stale\": " << telemetry.stale
+             << ", \"bytes_sent\": " << telemetry.bytes_sent << ", \"bytes_received\": " << telemetry.bytes_received
+             << ", \"mean_latency\": " << (telemetry.latencies > 0 ? telemetry.latency_sum / telemetry.latencies : 0.0)
+             << ", \"latency_histogram\": [";
+
+        for (uint32_t j = 0; j < LATENCY_BUCKETS; j++) {
+            if (j > 0) file << ", ";
+            file << telemetry.latency_histogram[j];
+        }
+        file << "]}";
+    }
+    file << "]}" << endl;
+}
+
+void MasterTelemetry::write_csv(double now, uint64_t outstanding) {
+    for (uint32_t i = 0; i < workers.size(); i++) {
+        const WorkerTelemetry &telemetry = workers[i];
+
+        file << (now - start_time) << "," << (now - last_write) << "," << (i + 1) << "," << telemetry.results << "," << telemetry.stale
+             << "," << telemetry.bytes_sent << "," << telemetry.bytes_received
+             << "," << (telemetry.latencies > 0 ? telemetry.latency_sum / telemetry.latencies : 0.0)
+             << "," << idle_time << "," << batches << "," << (batches > 0 ? (double)batch_results / batches : 0.0)
+             << "," << max_batch << "," << outstanding;
+
+        for (uint32_t j = 0; j < LATENCY_BUCKETS; j++) file << "," << telemetry.latency_histogram[j];
+        file << endl;
+    }
+}
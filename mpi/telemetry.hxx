@@ -0,0 +1,79 @@
+#ifndef TAO_MPI_TELEMETRY_H
+#define TAO_MPI_TELEMETRY_H
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "stdint.h"
+
+using std::string;
+using std::vector;
+
+/**
+ *  What the master sees of each worker and of itself, written to a file every interval seconds. Each
+ *  write covers the time since the previous one: per worker the results received (and how many were
+ *  stale), the bytes sent and received, and a histogram of the time from sending an individual to
+ *  getting its result; for the master the time it spent waiting for results, the number of results
+ *  it found waiting each time it looked (its queue depth) and the individuals it has outstanding.
+ *
+ *  A filename ending in .csv gets a row per worker for each write, anything else gets one JSON object
+ *  per line.
+ */
+class MasterTelemetry {
+    private:
+        //bucket i counts latencies of 2^i to 2^(i+1) microseconds, the first and last also take anything below and above
+        static const uint32_t LATENCY_BUCKETS = 32;
+
+        struct WorkerTelemetry {
+            uint64_t results;
+            uint64_t stale;
+            uint64_t bytes_sent;
+            uint64_t bytes_received;
+            uint64_t latencies;
+            double latency_sum;
+            vector<uint64_t> latency_histogram;
+        };
+
+        std::ofstream file;
+        bool csv;
+        uint32_t interval;
+        uint64_t message_size;
+
+        double start_time;
+        double last_write;
+
+        vector<WorkerTelemetry> workers;
+
+        uint64_t batches;
+        uint64_t batch_results;
+        uint64_t max_batch;
+        double idle_time;
+
+        void reset();
+        void write_json(double now, uint64_t outstanding);
+        void write_csv(double now, uint64_t outstanding);
+
+    public:
+        MasterTelemetry(const string &filename, uint32_t interval, int number_workers, uint64_t message_size) throw (string);
+
+        void sent(int worker) {
+            workers[worker].bytes_sent += message_size;
+        }
+
+        //latency is negative if it is unknown (the individual was re-issued)
+        void received(int worker, double latency, bool stale);
+
+        //a batch of results the master found waiting, after waiting idle seconds for them
+        void received_batch(uint32_t number_results, double idle) {
+            batches++;
+            batch_results += number_results;
+            if (number_results > max_batch) max_batch = number_results;
+            idle_time += idle;
+        }
+
+        //writes if the interval has passed, or always if force is true
+        void write(uint64_t outstanding, bool force = false);
+};
+
+#endif
@@ -1,13 +1,21 @@
+#include <cstdlib>
+#include <ctime>
+#include <functional>
 #include <vector>
 #include <iostream>
+#include <thread>
 
 #include "stdint.h"
 
 #include "gradient.hxx"
 
+#include "util/arguments.hxx"
+
 using std::vector;
 using std::cout;
+using std::cerr;
 using std::endl;
+using std::thread;
 
 void get_gradient(double (*objective_function)(const std::vector<double> &), const vector<double> &point, const vector<double> &step, vector <double> &gradient) {
     vector <double> point_copy(point);
@@ -33,3 +41,96 @@ bool gradient_below_threshold(const vector<double> &gradient, const vector<doubl
 	}
 	return true;
 }
+
+static void evaluate_points(double (*objective_function)(const std::vector<double> &), const vector< vector<double> > &points, vector<double> &fitnesses, uint32_t first, uint32_t stride) {
+    for (uint32_t i = first; i < points.size(); i += stride) {
+        fitnesses[i] = objective_function(points[i]);
+    }
+}
+
+void get_spsa_gradient(double (*objective_function)(const std::vector<double> &), const vector<double> &point, const vector<double> &step, uint32_t perturbations, uint32_t threads, mt19937 &random_number_generator, vector <double> &gradient) {
+    uint32_t number_parameters = point.size();
+
+    //points[2 * k] = point + step * delta, points[2 * k + 1] = point - step * delta, with delta[i] = +/- 1
+    vector< vector<double> > deltas(perturbations, vector<double>(number_parameters, 0.0));
+    vector< vector<double> > points(perturbations * 2, point);
+    vector<double> fitnesses(perturbations * 2, 0.0);
+
+    for (uint32_t k = 0; k < perturbations; k++) {
+        for (uint32_t i = 0; i < number_parameters; i++) {
+            deltas[k][i] = (random_number_generator() & 1) ? 1.0 : -1.0;
+            points[2 * k][i] += step[i] * deltas[k][i];
+            points[2 * k + 1][i] -= step[i] * deltas[k][i];
+        }
+    }
+
+    if (threads > points.size()) threads = points.size();
+
+    if (threads <= 1) {
+        evaluate_points(objective_function, points, fitnesses, 0, 1);
+    } else {
+        vector<thread> workers;
+        for (uint32_t t = 0; t < threads; t++) {
+            workers.push_back(thread(evaluate_points, objective_function, std::cref(points), std::ref(fitnesses), t, threads));
+        }
+        for (uint32_t t = 0; t < threads; t++) workers[t].join();
+    }
+
+    gradient.assign(number_parameters, 0.0);
+    for (uint32_t k = 0; k < perturbations; k++) {
+        double difference = fitnesses[2 * k] - fitnesses[2 * k + 1];
+        for (uint32_t i = 0; i < number_parameters; i++) {
+            gradient[i] += difference / (2.0 * step[i] * deltas[k][i]);
+        }
+    }
+
+    for (uint32_t i = 0; i < number_parameters; i++) gradient[i] /= perturbations;
+}
+
+GradientEstimator::GradientEstimator(const vector<string> &arguments) {
+    string gradient_type;
+    if (!get_argument(arguments, "--gradient", false, gradient_type)) {
+        gradient_type = "finite_difference";
+    }
+
+    if (gradient_type.compare("finite_difference") == 0) {
+        use_spsa = false;
+    } else if (gradient_type.compare("spsa") == 0) {
+        use_spsa = true;
+    } else {
+        cerr << "Improperly specified gradient: '" << gradient_type.c_str() << "'" << endl;
+        cerr << "Possibilities are:" << endl;
+        cerr << "   finite_difference" << endl;
+        cerr << "   spsa" << endl;
+        exit(1);
+    }
+
+    spsa_perturbations = 4;
+    threads = 1;
+
+    if (use_spsa) {
+        if (!get_argument(arguments, "--spsa_perturbations", false, spsa_perturbations)) {
+            cerr << "Argument '--spsa_perturbations <i>' not found, using default of " << spsa_perturbations << endl;
+        }
+
+        if (spsa_perturbations == 0) {
+            cerr << "Argument '--spsa_perturbations <i>' must be greater than 0." << endl;
+            exit(1);
+        }
+
+        if (!get_argument(arguments, "--gradient_threads", false, threads)) {
+            cerr << "Argument '--gradient_threads <i>' not found, using default of " << threads << endl;
+        }
+    }
+
+    random_number_generator = mt19937(time(0));
+}
+
+void GradientEstimator::estimate(double (*objective_function)(const std::vector<double> &), const vector<double> &point, const vector<double> &step, vector <double> &gradient) {
+    if (use_spsa) {
+        get_spsa_gradient(objective_function, point, step, spsa_perturbations, threads, random_number_generator, gradient);
+    } else {
+        gradient.resize(point.size());
+        get_gradient(objective_function, point, step, gradient);
+    }
+}
@@ -1,13 +1,46 @@
 #ifndef TAO_GRADIENT_H
 #define TAO_GRADIENT_H
 
+#include <random>
+#include <string>
 #include <vector>
 
+#include "stdint.h"
+
+using std::mt19937;
+using std::string;
 using std::vector;
 
 void get_gradient(double (*objective_function)(const std::vector<double> &), const vector<double> &point, const vector<double> &step, vector <double> &gradient);
 
+/**
+ *  Simultaneous perturbation (SPSA) gradient estimate, averaged over the given number of random
+ *  +/- step perturbations of all parameters at once. This takes 2 * perturbations evaluations
+ *  regardless of the number of parameters, which are split between threads if threads > 1
+ *  (so the objective function must be thread safe in that case).
+ */
+void get_spsa_gradient(double (*objective_function)(const std::vector<double> &), const vector<double> &point, const vector<double> &step, uint32_t perturbations, uint32_t threads, mt19937 &random_number_generator, vector <double> &gradient);
+
 bool gradient_below_threshold(const vector<double> &gradient, const vector<double> &threshold);
 
+/**
+ *  Selects the gradient calculation from the arguments:
+ *      --gradient <finite_difference|spsa>     (default finite_difference)
+ *      --spsa_perturbations <i>                (default 4)
+ *      --gradient_threads <i>                  (default 1)
+ */
+class GradientEstimator {
+    private:
+        bool use_spsa;
+        uint32_t spsa_perturbations;
+        uint32_t threads;
+
+        mt19937 random_number_generator;
+
+    public:
+        GradientEstimator(const vector<string> &arguments);
+
+        void estimate(double (*objective_function)(const std::vector<double> &), const vector<double> &point, const vector<double> &step, vector <double> &gradient);
+};
 
 #endif
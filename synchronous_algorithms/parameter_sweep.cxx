@@ -17,57 +17,697 @@
  * along with TAO.  If not, see <http://www.gnu.org/licenses/>.
  * */
 
-#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <deque>
+#include <fstream>
+#include <iostream>
 #include <limits>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
 
 #include "stdint.h"
 
 #include "parameter_sweep.hxx"
+#include "util/arguments.hxx"
 #include "util/vector_io.hxx"
 
 using namespace std;
 
-void parameter_sweep(const std::vector<double> &min_bound, const std::vector<double> &max_bound, const std::vector<double> &step_size, double (*objective_function)(const std::vector<double> &)) {
-    vector<double> parameters(min_bound);
+SweepGrid::SweepGrid(const vector<double> &min_bound, const vector<double> &max_bound, const vector<double> &step_size) throw (string) {
+    if (min_bound.size() != max_bound.size() || min_bound.size() != step_size.size()) {
+        ostringstream err_msg;
+        err_msg << "SweepGrid: min_bound (" << min_bound.size() << "), max_bound (" << max_bound.size() << ") and step_size (" << step_size.size() << ") must be the same size.";
+        throw err_msg.str();
+    }
+
+    this->min_bound = min_bound;
+    this->step_size = step_size;
+
+    steps.resize(min_bound.size());
+    number_points = 1;
+    for (uint32_t i = 0; i < min_bound.size(); i++) {
+        if (step_size[i] <= 0 || max_bound[i] < min_bound[i]) {
+            ostringstream err_msg;
+            err_msg << "SweepGrid: parameter " << i << " has an invalid range, min_bound: " << min_bound[i] << ", max_bound: " << max_bound[i] << ", step_size: " << step_size[i];
+            throw err_msg.str();
+        }
+
+        //allow for floating point error so the max bound is included when it is a multiple of the step size
+        steps[i] = (uint64_t)(((max_bound[i] - min_bound[i]) / step_size[i]) + 1e-9) + 1;
+
+        if (number_points > numeric_limits<uint64_t>::max() / steps[i]) {
+            throw string("SweepGrid: number of grid points does not fit in a 64 bit index.");
+        }
+        number_points *= steps[i];
+    }
+}
+
+uint32_t SweepGrid::get_number_parameters() const {
+    return steps.size();
+}
+
+uint64_t SweepGrid::get_steps(uint32_t parameter) const {
+    return steps[parameter];
+}
+
+uint64_t SweepGrid::size() const {
+    return number_points;
+}
+
+void SweepGrid::get_point(uint64_t index, vector<double> &point) const {
+    point.resize(steps.size());
+    for (uint32_t i = 0; i < steps.size(); i++) {
+        point[i] = min_bound[i] + (index % steps[i]) * step_size[i];
+        index /= steps[i];
+    }
+}
+
+
+static bool worse_result(const SweepResult &r1, const SweepResult &r2) {
+    //used for a min heap, so the worst result is on top
+    return r1.fitness > r2.fitness;
+}
+
+SweepResults::SweepResults(uint32_t k) {
+    this->k = k;
+}
+
+uint32_t SweepResults::get_k() const {
+    return k;
+}
+
+uint32_t SweepResults::size() const {
+    return heap.size();
+}
+
+bool SweepResults::insert(uint64_t index, double fitness) {
+    if (k == 0 || std::isnan(fitness)) return false;
+
+    if (heap.size() < k) {
+        SweepResult result;
+        result.index = index;
+        result.fitness = fitness;
+        heap.push_back(result);
+        push_heap(heap.begin(), heap.end(), worse_result);
+        return true;
+    }
+
+    if (fitness <= heap.front().fitness) return false;
+
+    pop_heap(heap.begin(), heap.end(), worse_result);
+    heap.back().index = index;
+    heap.back().fitness = fitness;
+    push_heap(heap.begin(), heap.end(), worse_result);
+    return true;
+}
+
+void SweepResults::merge(const SweepResults &other) {
+    for (uint32_t i = 0; i < other.heap.size(); i++) {
+        insert(other.heap[i].index, other.heap[i].fitness);
+    }
+}
+
+const vector<SweepResult>& SweepResults::get_results() const {
+    return heap;
+}
+
+static bool better_result(const SweepResult &r1, const SweepResult &r2) {
+    if (r1.fitness != r2.fitness) return r1.fitness > r2.fitness;
+    return r1.index < r2.index;
+}
+
+void SweepResults::get_sorted(vector<SweepResult> &sorted) const {
+    sorted.assign(heap.begin(), heap.end());
+    sort(sorted.begin(), sorted.end(), better_result);
+}
+
+
+/**
+ *  The state of each thread in the sweep. The ranges and in progress chunk are only modified while holding
+ *  the mutex, and the results of a chunk are merged while holding it, so locking every thread gives a
+ *  consistent view of the work remaining for checkpoints.
+ */
+class SweepThread {
+    public:
+        mutex lock;
+        deque< pair<uint64_t, uint64_t> > ranges;
+        pair<uint64_t, uint64_t> in_progress;
+        SweepResults results;
+        uint64_t evaluations;
+
+        SweepThread(uint32_t k) : in_progress(0, 0), results(k), evaluations(0) {
+        }
+
+        uint64_t remaining() const {
+            uint64_t total = 0;
+            for (uint32_t i = 0; i < ranges.size(); i++) total += ranges[i].second - ranges[i].first;
+            return total;
+        }
+};
+
+class Sweep {
+    private:
+        const SweepGrid &grid;
+        double (*objective_function)(const std::vector<double> &);
+        uint64_t chunk_size;
+
+        vector<SweepThread*> threads;
+        const SweepResults &initial_results;
 
-    //TODO: would be cool to have queue of the best found parameters (of a user specified size) to print out at the end.
+        string checkpoint_filename;
+        uint32_t checkpoint_interval;
+        mutex checkpoint_lock;
+        atomic<chrono::steady_clock::rep> last_checkpoint;     //steady_clock ticks, read by every thread without the lock
+
+        bool checkpoint_due();
+
+        bool take_chunk(uint32_t id, pair<uint64_t, uint64_t> &chunk);
+        bool steal(uint32_t id);
+        void checkpoint(bool force);
+
+    public:
+        Sweep(const SweepGrid &grid, double (*objective_function)(const std::vector<double> &), const vector< pair<uint64_t, uint64_t> > &ranges, uint32_t number_threads, uint64_t chunk_size, const SweepResults &initial_results, const string &checkpoint_filename, uint32_t checkpoint_interval);
+        ~Sweep();
+
+        void run(uint32_t id);
+        uint64_t finish(SweepResults &results);
+};
+
+Sweep::Sweep(const SweepGrid &grid, double (*objective_function)(const std::vector<double> &), const vector< pair<uint64_t, uint64_t> > &ranges, uint32_t number_threads, uint64_t chunk_size, const SweepResults &initial_results, const string &checkpoint_filename, uint32_t checkpoint_interval) : grid(grid), initial_results(initial_results) {
+    this->objective_function = objective_function;
+    this->chunk_size = chunk_size;
+    this->checkpoint_filename = checkpoint_filename;
+    this->checkpoint_interval = checkpoint_interval;
+    last_checkpoint = chrono::steady_clock::now().time_since_epoch().count();
+
+    for (uint32_t i = 0; i < number_threads; i++) threads.push_back(new SweepThread(initial_results.get_k()));
+
+    //give each thread a contiguous and (nearly) equal part of the ranges
+    uint64_t total = 0;
+    for (uint32_t i = 0; i < ranges.size(); i++) total += ranges[i].second - ranges[i].first;
+
+    uint32_t current_thread = 0;
+    uint64_t assigned = 0;
+    for (uint32_t i = 0; i < ranges.size(); i++) {
+        uint64_t first = ranges[i].first;
+
+        while (first < ranges[i].second) {
+            uint64_t thread_end = ((current_thread + 1) * total) / number_threads;
+            uint64_t length = min(ranges[i].second - first, thread_end - assigned);
+
+            if (length > 0) threads[current_thread]->ranges.push_back(pair<uint64_t, uint64_t>(first, first + length));
+            first += length;
+            assigned += length;
+
+            if (assigned == thread_end && current_thread + 1 < number_threads) current_thread++;
+        }
+    }
+}
+
+Sweep::~Sweep() {
+    for (uint32_t i = 0; i < threads.size(); i++) delete threads[i];
+}
+
+bool Sweep::take_chunk(uint32_t id, pair<uint64_t, uint64_t> &chunk) {
+    SweepThread *thread = threads[id];
+    lock_guard<mutex> guard(thread->lock);
+
+    if (thread->ranges.empty()) return false;
+
+    pair<uint64_t, uint64_t> &range = thread->ranges.front();
+    chunk.first = range.first;
+    chunk.second = min(range.second, range.first + chunk_size);
+
+    range.first = chunk.second;
+    if (range.first == range.second) thread->ranges.pop_front();
+
+    thread->in_progress = chunk;
+    return true;
+}
+
+/**
+ *  Takes half of the remaining indices from the thread with the most remaining. Both threads are locked
+ *  (in order) so the stolen indices are always in one of their ranges for checkpoints.
+ */
+bool Sweep::steal(uint32_t id) {
+    while (true) {
+        uint32_t victim = id;
+        uint64_t most_remaining = 0;
+        for (uint32_t i = 0; i < threads.size(); i++) {
+            if (i == id) continue;
+
+            lock_guard<mutex> guard(threads[i]->lock);
+            uint64_t remaining = threads[i]->remaining();
+            if (remaining > most_remaining) {
+                most_remaining = remaining;
+                victim = i;
+            }
+        }
+
+        if (victim == id) return false;
+
+        lock_guard<mutex> first_guard(threads[min(id, victim)]->lock);
+        lock_guard<mutex> second_guard(threads[max(id, victim)]->lock);
+
+        deque< pair<uint64_t, uint64_t> > &victim_ranges = threads[victim]->ranges;
+        if (victim_ranges.empty()) continue;    //the victim finished its work in the mean time, look again
+
+        if (victim_ranges.size() > 1) {
+            threads[id]->ranges.push_back(victim_ranges.back());
+            victim_ranges.pop_back();
+        } else {
+            pair<uint64_t, uint64_t> &range = victim_ranges.front();
+            uint64_t middle = range.first + ((range.second - range.first) / 2);
+
+            threads[id]->ranges.push_back(pair<uint64_t, uint64_t>(middle, range.second));
+            range.second = middle;
+            if (range.first == range.second) victim_ranges.pop_front();
+        }
+        return true;
+    }
+}
+
+void Sweep::run(uint32_t id) {
+    SweepThread *thread = threads[id];
+    pair<uint64_t, uint64_t> chunk;
+    vector<double> point(grid.get_number_parameters());
+
+    while (true) {
+        if (!take_chunk(id, chunk)) {
+            if (!steal(id)) break;
+            continue;
+        }
+
+        SweepResults chunk_results(thread->results.get_k());
+        for (uint64_t index = chunk.first; index < chunk.second; index++) {
+            grid.get_point(index, point);
+            chunk_results.insert(index, objective_function(point));
+        }
+
+        {
+            lock_guard<mutex> guard(thread->lock);
+            thread->results.merge(chunk_results);
+            thread->evaluations += chunk.second - chunk.first;
+            thread->in_progress = pair<uint64_t, uint64_t>(0, 0);
+        }
+
+        checkpoint(false);
+    }
+}
+
+bool Sweep::checkpoint_due() {
+    if (checkpoint_interval == 0) return false;
+
+    chrono::steady_clock::time_point last(chrono::steady_clock::duration(last_checkpoint.load()));
+    return chrono::steady_clock::now() - last >= chrono::seconds(checkpoint_interval);
+}
+
+/**
+ *  Only one thread writes a checkpoint at a time, the others keep working.
+ */
+void Sweep::checkpoint(bool force) {
+    if (checkpoint_filename.empty()) return;
+    if (!force && !checkpoint_due()) return;
+
+    if (force) {
+        checkpoint_lock.lock();
+    } else if (!checkpoint_lock.try_lock()) {
+        return;
+    }
+
+    if (!force && !checkpoint_due()) {
+        checkpoint_lock.unlock();
+        return;
+    }
 
+    vector< pair<uint64_t, uint64_t> > remaining;
+    SweepResults results(initial_results);
+
+    for (uint32_t i = 0; i < threads.size(); i++) threads[i]->lock.lock();
+    for (uint32_t i = 0; i < threads.size(); i++) {
+        if (threads[i]->in_progress.first != threads[i]->in_progress.second) remaining.push_back(threads[i]->in_progress);
+        remaining.insert(remaining.end(), threads[i]->ranges.begin(), threads[i]->ranges.end());
+        results.merge(threads[i]->results);
+    }
+    for (uint32_t i = 0; i < threads.size(); i++) threads[i]->lock.unlock();
+
+    sort(remaining.begin(), remaining.end());
+
+    try {
+        write_sweep_checkpoint(checkpoint_filename, grid, remaining, results);
+    } catch (string err_msg) {
+        cerr << "parameter sweep could not write checkpoint: " << err_msg << endl;
+    }
+
+    last_checkpoint = chrono::steady_clock::now().time_since_epoch().count();
+    checkpoint_lock.unlock();
+}
+
+uint64_t Sweep::finish(SweepResults &results) {
+    checkpoint(true);
+
+    uint64_t evaluations = 0;
+    for (uint32_t i = 0; i < threads.size(); i++) {
+        results.merge(threads[i]->results);
+        evaluations += threads[i]->evaluations;
+    }
+    return evaluations;
+}
+
+uint64_t parameter_sweep(const SweepGrid &grid, double (*objective_function)(const std::vector<double> &), const vector< pair<uint64_t, uint64_t> > &ranges, uint32_t number_threads, uint64_t chunk_size, SweepResults &results, const string &checkpoint_filename, uint32_t checkpoint_interval) {
+    if (number_threads == 0) number_threads = 1;
+    if (chunk_size == 0) chunk_size = 1;
+
+    Sweep sweep(grid, objective_function, ranges, number_threads, chunk_size, results, checkpoint_filename, checkpoint_interval);
+
+    if (number_threads == 1) {
+        sweep.run(0);
+    } else {
+        vector<thread> workers;
+        for (uint32_t i = 0; i < number_threads; i++) workers.push_back(thread(&Sweep::run, &sweep, i));
+        for (uint32_t i = 0; i < number_threads; i++) workers[i].join();
+    }
+
+    return sweep.finish(results);
+}
+
+/**
+ *  The checkpoint is a text file:
+ *      <number of parameters> <number of grid points> <k>
+ *      <number of remaining ranges>
+ *      <first> <last + 1>                  (for each remaining range)
+ *      <number of results>
+ *      <index> <fitness>                   (for each result)
+ *  It is written to a temporary file which is then renamed, so a crash while writing does not lose the previous checkpoint.
+ */
+void write_sweep_checkpoint(const string &checkpoint_filename, const SweepGrid &grid, const vector< pair<uint64_t, uint64_t> > &ranges, const SweepResults &results) throw (string) {
+    string temporary_filename = checkpoint_filename + ".tmp";
+
+    ofstream checkpoint_file(temporary_filename.c_str());
+    if (!checkpoint_file.is_open()) throw string("could not open '" + temporary_filename + "' for writing.");
+
+    checkpoint_file.precision(17);
+    checkpoint_file << grid.get_number_parameters() << " " << grid.size() << " " << results.get_k() << endl;
+
+    checkpoint_file << ranges.size() << endl;
+    for (uint32_t i = 0; i < ranges.size(); i++) {
+        checkpoint_file << ranges[i].first << " " << ranges[i].second << endl;
+    }
+
+    const vector<SweepResult> &kept = results.get_results();
+    checkpoint_file << kept.size() << endl;
+    for (uint32_t i = 0; i < kept.size(); i++) {
+        checkpoint_file << kept[i].index << " " << kept[i].fitness << endl;
+    }
+    checkpoint_file.close();
+
+    if (checkpoint_file.fail() || rename(temporary_filename.c_str(), checkpoint_filename.c_str()) != 0) {
+        throw string("could not write checkpoint file '" + checkpoint_filename + "'.");
+    }
+}
+
+/**
+ *  Returns false if the checkpoint file does not exist.
+ */
+bool read_sweep_checkpoint(const string &checkpoint_filename, const SweepGrid &grid, vector< pair<uint64_t, uint64_t> > &ranges, SweepResults &results) throw (string) {
+    ifstream checkpoint_file(checkpoint_filename.c_str());
+    if (!checkpoint_file.is_open()) return false;
+
+    uint32_t number_parameters, k;
+    uint64_t number_points, number_ranges, number_results;
+
+    checkpoint_file >> number_parameters >> number_points >> k;
+    if (checkpoint_file.fail() || number_parameters != grid.get_number_parameters() || number_points != grid.size()) {
+        throw string("checkpoint file '" + checkpoint_filename + "' was not written for this parameter sweep.");
+    }
+
+    checkpoint_file >> number_ranges;
+    ranges.resize(number_ranges);
+    for (uint64_t i = 0; i < number_ranges; i++) {
+        checkpoint_file >> ranges[i].first >> ranges[i].second;
+    }
+
+    checkpoint_file >> number_results;
+    for (uint64_t i = 0; i < number_results; i++) {
+        uint64_t index;
+        double fitness;
+        checkpoint_file >> index >> fitness;
+        results.insert(index, fitness);
+    }
+
+    if (checkpoint_file.fail()) throw string("could not read checkpoint file '" + checkpoint_filename + "'.");
+    return true;
+}
+
+void print_sweep_results(const SweepGrid &grid, const SweepResults &results) {
+    vector<SweepResult> sorted;
+    results.get_sorted(sorted);
+
+    vector<double> point;
+    cout << "best " << sorted.size() << " points found:" << endl;
+    for (uint32_t i = 0; i < sorted.size(); i++) {
+        grid.get_point(sorted[i].index, point);
+        cout << sorted[i].index << " -- " << vector_to_string(point) << " -- " << sorted[i].fitness << endl;
+    }
+}
+
+static bool better_point(const pair< double, vector<double> > &p1, const pair< double, vector<double> > &p2) {
+    return p1.first > p2.first;
+}
+
+/**
+ *  A box of points on a grid, from index lo to index hi (inclusive) along each parameter.
+ */
+struct SweepBox {
+    vector<int64_t> lo, hi;
+};
+
+/**
+ *  Replaces each box in pieces by the boxes covering its points that are not in taken.
+ */
+static void subtract_box(vector<SweepBox> &pieces, const SweepBox &taken) {
+    vector<SweepBox> remaining;
+
+    for (uint32_t i = 0; i < pieces.size(); i++) {
+        SweepBox piece = pieces[i];
+
+        bool overlaps = true;
+        for (uint32_t j = 0; j < piece.lo.size() && overlaps; j++) {
+            overlaps = piece.lo[j] <= taken.hi[j] && taken.lo[j] <= piece.hi[j];
+        }
+
+        if (!overlaps) {
+            remaining.push_back(piece);
+            continue;
+        }
+
+        //cut off the slabs of the piece below and above taken along each parameter, what is left is inside it
+        for (uint32_t j = 0; j < piece.lo.size(); j++) {
+            if (piece.lo[j] < taken.lo[j]) {
+                SweepBox below = piece;
+                below.hi[j] = taken.lo[j] - 1;
+                remaining.push_back(below);
+                piece.lo[j] = taken.lo[j];
+            }
+
+            if (piece.hi[j] > taken.hi[j]) {
+                SweepBox above = piece;
+                above.lo[j] = taken.hi[j] + 1;
+                remaining.push_back(above);
+                piece.hi[j] = taken.hi[j];
+            }
+        }
+    }
+
+    pieces.swap(remaining);
+}
+
+/**
+ *  Sweeps the grid at step_size, then for each level sweeps the cell of +/- the previous step size around
+ *  each of the k best points found so far at the previous step size / refine_factor, keeping the k best points
+ *  over all the cells of that level. Cells are swept one at a time, each using all the threads. The refine factor
+ *  is an integer so every level's grid contains the points of the one before it.
+ */
+static void refined_parameter_sweep(const std::vector<double> &min_bound, const std::vector<double> &max_bound, const std::vector<double> &step_size, double (*objective_function)(const std::vector<double> &), uint32_t number_threads, uint32_t k, uint32_t refine_levels, uint32_t refine_factor) {
+    uint32_t number_parameters = min_bound.size();
+
+    SweepGrid grid(min_bound, max_bound, step_size);
+    SweepResults results(k);
+
+    uint64_t chunk_size = max((uint64_t)1, grid.size() / (number_threads * 16));
+    uint64_t evaluations = parameter_sweep(grid, objective_function, vector< pair<uint64_t, uint64_t> >(1, pair<uint64_t, uint64_t>(0, grid.size())), number_threads, chunk_size, results, "", 0);
+
+    vector<SweepResult> sorted;
+    results.get_sorted(sorted);
+
+    vector< pair< double, vector<double> > > best(sorted.size());
+    for (uint32_t i = 0; i < sorted.size(); i++) {
+        best[i].first = sorted[i].fitness;
+        grid.get_point(sorted[i].index, best[i].second);
+    }
+
+    cout << "level 0 -- step_size: " << vector_to_string(step_size) << " -- evaluations: " << evaluations << " -- best: " << (best.empty() ? 0.0 : best[0].first) << endl;
+
+    vector<double> current_step(step_size);
+    vector<double> next_step(number_parameters);
+    vector<double> cell_min(number_parameters), cell_max(number_parameters), point;
+
+    for (uint32_t level = 1; level <= refine_levels; level++) {
+        for (uint32_t j = 0; j < number_parameters; j++) next_step[j] = current_step[j] / refine_factor;
+
+        uint64_t level_evaluations = 0;
+        vector< pair< double, vector<double> > > level_best;
+
+        /**
+         *  Neighboring cells overlap. All the cells are on the grid of next_step from the min bound, so each cell
+         *  is a box of indices on that grid, and only the boxes of it that no earlier cell of this level covers
+         *  are swept. A point skipped in a cell was compared against the k best of the earlier cell, so the k best
+         *  of the level are not lost.
+         */
+        vector<SweepBox> swept;
+        SweepBox cell;
+        cell.lo.resize(number_parameters);
+        cell.hi.resize(number_parameters);
+
+        for (uint32_t i = 0; i < best.size(); i++) {
+            for (uint32_t j = 0; j < number_parameters; j++) {
+                cell_min[j] = max(min_bound[j], best[i].second[j] - current_step[j]);
+                cell_max[j] = min(max_bound[j], best[i].second[j] + current_step[j]);
+
+                cell.lo[j] = llround((cell_min[j] - min_bound[j]) / next_step[j]);
+                //allow for floating point error as SweepGrid does
+                cell.hi[j] = (int64_t)(((cell_max[j] - min_bound[j]) / next_step[j]) + 1e-9);
+            }
+
+            vector<SweepBox> pieces(1, cell);
+            for (uint32_t b = 0; b < swept.size() && !pieces.empty(); b++) subtract_box(pieces, swept[b]);
+            swept.push_back(cell);
+
+            for (uint32_t p = 0; p < pieces.size(); p++) {
+                for (uint32_t j = 0; j < number_parameters; j++) {
+                    cell_min[j] = min_bound[j] + (pieces[p].lo[j] * next_step[j]);
+                    cell_max[j] = min_bound[j] + (pieces[p].hi[j] * next_step[j]);
+                }
+
+                SweepGrid piece(cell_min, cell_max, next_step);
+                SweepResults piece_results(k);
+
+                chunk_size = max((uint64_t)1, piece.size() / (number_threads * 16));
+                level_evaluations += parameter_sweep(piece, objective_function, vector< pair<uint64_t, uint64_t> >(1, pair<uint64_t, uint64_t>(0, piece.size())), number_threads, chunk_size, piece_results, "", 0);
+
+                const vector<SweepResult> &kept = piece_results.get_results();
+                for (uint32_t r = 0; r < kept.size(); r++) {
+                    piece.get_point(kept[r].index, point);
+                    level_best.push_back(pair< double, vector<double> >(kept[r].fitness, point));
+                }
+            }
+        }
+
+        sort(level_best.begin(), level_best.end(), better_point);
+        if (level_best.size() > k) level_best.resize(k);
+        best = level_best;
+
+        evaluations += level_evaluations;
+        current_step = next_step;
+
+        cout << "level " << level << " -- step_size: " << vector_to_string(current_step) << " -- evaluations: " << level_evaluations << " -- best: " << (best.empty() ? 0.0 : best[0].first) << endl;
+    }
+
+    cout << "best " << best.size() << " points found:" << endl;
+    for (uint32_t i = 0; i < best.size(); i++) {
+        cout << vector_to_string(best[i].second) << " -- " << best[i].first << endl;
+    }
+
+    //the full grid at the finest step size may not fit in 64 bits, so it is calculated as a double
+    double full_grid_evaluations = 1.0;
+    for (uint32_t j = 0; j < number_parameters; j++) {
+        full_grid_evaluations *= floor(((max_bound[j] - min_bound[j]) / current_step[j]) + 1e-9) + 1;
+    }
+
+    cout << "total    evaluations: " << evaluations << endl;
+    cout << "full grid evaluations at the finest step size: " << full_grid_evaluations << endl;
+    cout << "evaluation savings: " << (full_grid_evaluations / evaluations) << " times fewer evaluations (" << (100.0 * (1.0 - (evaluations / full_grid_evaluations))) << "% saved)" << endl;
+}
+
+void parameter_sweep(const vector<string> &arguments, const std::vector<double> &min_bound, const std::vector<double> &max_bound, const std::vector<double> &step_size, double (*objective_function)(const std::vector<double> &)) {
     cout.precision(15);
 
-    double best_fitness = -numeric_limits<double>::max();
-    double current_fitness;
+    SweepGrid grid(min_bound, max_bound, step_size);
 
     for (uint32_t i = 0; i < max_bound.size(); i++) {
-        cout << "max_bound[" << i << "]: " << max_bound[i] << ", min_bound[" << i << "]: " << min_bound[i] << ", step_size[" << i << "]: " << step_size[i] << ", steps: " << ((max_bound[i] - min_bound[i]) / step_size[i]) + 1 << endl;
+        cout << "max_bound[" << i << "]: " << max_bound[i] << ", min_bound[" << i << "]: " << min_bound[i] << ", step_size[" << i << "]: " << step_size[i] << ", steps: " << grid.get_steps(i) << endl;
+    }
+    cout << "expected evaluations: " << grid.size() << endl;
+
+    uint32_t number_threads = 1;
+    if (!get_argument(arguments, "--sweep_threads", false, number_threads)) {
+        cerr << "Argument '--sweep_threads <i>' not found, using default of " << number_threads << "." << endl;
     }
+    if (number_threads == 0) number_threads = max(1u, thread::hardware_concurrency());
 
-    uint64_t expected_evaluations = ((max_bound[0] - min_bound[0]) / step_size[0]) + 1;
-    for (uint32_t i = 1; i < max_bound.size(); i++) {
-        expected_evaluations *= ((max_bound[i] - min_bound[i]) / step_size[i]) + 1;
+    uint32_t k = 10;
+    if (!get_argument(arguments, "--sweep_best", false, k)) {
+        cerr << "Argument '--sweep_best <i>' not found, using default of " << k << "." << endl;
     }
 
-    cout << "expected evaluations: " << expected_evaluations << endl;
+    uint32_t refine_levels = 0;
+    if (get_argument(arguments, "--sweep_refine_levels", false, refine_levels) && refine_levels > 0) {
+        double refine_factor = 4.0;
+        if (!get_argument(arguments, "--sweep_refine_factor", false, refine_factor)) {
+            cerr << "Argument '--sweep_refine_factor <i>' not found, using default of " << refine_factor << "." << endl;
+        }
 
-    uint64_t iteration = 0;
-    while (iteration < expected_evaluations) {
-        current_fitness = objective_function(parameters);
+        if (refine_factor < 2.0 || refine_factor != floor(refine_factor)) {
+            cerr << "Argument '--sweep_refine_factor <i>' must be an integer greater than 1, not " << refine_factor << "." << endl;
+            exit(1);
+        }
 
-        if (current_fitness >= best_fitness) {
-            cout << iteration << " -- " << vector_to_string(parameters) << " -- " << current_fitness << endl;
-            best_fitness = current_fitness;
+        if (argument_exists(arguments, "--sweep_checkpoint")) {
+            cerr << "Argument '--sweep_checkpoint <file>' is not used by refined sweeps." << endl;
         }
 
-        parameters[0] += step_size[0];
-        for (uint32_t i = 1; i < parameters.size(); i++) {
-            if (parameters[i - 1] > max_bound[i - 1]) {
-                parameters[i - 1] = min_bound[i - 1];
-                parameters[i] += step_size[i];
-            }
+        refined_parameter_sweep(min_bound, max_bound, step_size, objective_function, number_threads, k, refine_levels, (uint32_t)refine_factor);
+        return;
+    }
+
+    uint64_t chunk_size;
+    if (!get_argument(arguments, "--sweep_chunk_size", false, chunk_size)) {
+        //small enough that work is balanced between the threads, large enough that locking is negligible
+        chunk_size = min((uint64_t)65536, max((uint64_t)1, grid.size() / (number_threads * 256)));
+        cerr << "Argument '--sweep_chunk_size <i>' not found, using default of " << chunk_size << "." << endl;
+    }
+
+    string checkpoint_filename;
+    uint32_t checkpoint_interval = 300;
+    if (get_argument(arguments, "--sweep_checkpoint", false, checkpoint_filename)) {
+        if (!get_argument(arguments, "--sweep_checkpoint_interval", false, checkpoint_interval)) {
+            cerr << "Argument '--sweep_checkpoint_interval <i>' not found, using default of " << checkpoint_interval << " seconds." << endl;
         }
+    }
+
+    SweepResults results(k);
+    vector< pair<uint64_t, uint64_t> > ranges;
 
-        iteration++;
+    if (!checkpoint_filename.empty() && read_sweep_checkpoint(checkpoint_filename, grid, ranges, results)) {
+        uint64_t remaining = 0;
+        for (uint32_t i = 0; i < ranges.size(); i++) remaining += ranges[i].second - ranges[i].first;
+        cout << "resuming from checkpoint '" << checkpoint_filename << "' with " << remaining << " evaluations remaining." << endl;
+    } else {
+        ranges.push_back(pair<uint64_t, uint64_t>(0, grid.size()));
     }
 
-    cout << "total    evaluations: " << iteration << endl;
+    uint64_t evaluations = parameter_sweep(grid, objective_function, ranges, number_threads, chunk_size, results, checkpoint_filename, checkpoint_interval);
+
+    print_sweep_results(grid, results);
+    cout << "total    evaluations: " << evaluations << endl;
 }
 
+void parameter_sweep(const std::vector<double> &min_bound, const std::vector<double> &max_bound, const std::vector<double> &step_size, double (*objective_function)(const std::vector<double> &)) {
+    parameter_sweep(vector<string>(), min_bound, max_bound, step_size, objective_function);
+}
@@ -20,8 +20,92 @@
 #ifndef TAO_PARAMETER_SWEEP_H
 #define TAO_PARAMETER_SWEEP_H
 
+#include <string>
+#include <utility>
 #include <vector>
 
+#include "stdint.h"
+
+using std::pair;
+using std::string;
+using std::vector;
+
+/**
+ *  Maps a linear index to a point on the grid, parameter 0 varies fastest:
+ *      index = i0 + steps[0] * (i1 + steps[1] * (i2 + ...)),  point[j] = min_bound[j] + ij * step_size[j]
+ */
+class SweepGrid {
+    private:
+        vector<double> min_bound;
+        vector<double> step_size;
+        vector<uint64_t> steps;
+        uint64_t number_points;
+
+    public:
+        SweepGrid(const vector<double> &min_bound, const vector<double> &max_bound, const vector<double> &step_size) throw (string);
+
+        uint32_t get_number_parameters() const;
+        uint64_t get_steps(uint32_t parameter) const;
+        uint64_t size() const;
+
+        void get_point(uint64_t index, vector<double> &point) const;
+};
+
+struct SweepResult {
+    uint64_t index;
+    double fitness;
+};
+
+/**
+ *  Keeps the k best (highest fitness) points found, as a heap with the worst kept point on top.
+ */
+class SweepResults {
+    private:
+        uint32_t k;
+        vector<SweepResult> heap;
+
+    public:
+        SweepResults(uint32_t k);
+
+        uint32_t get_k() const;
+        uint32_t size() const;
+
+        //returns true if the point was kept
+        bool insert(uint64_t index, double fitness);
+        void merge(const SweepResults &other);
+
+        const vector<SweepResult>& get_results() const;
+        void get_sorted(vector<SweepResult> &sorted) const;    //best first
+};
+
+/**
+ *  Evaluates the grid indices in ranges ([first, second) pairs) using a pool of threads. Each thread is
+ *  given a contiguous part of the ranges, evaluates it chunk_size indices at a time and steals half of the
+ *  remaining indices of another thread when it runs out. If checkpoint_filename is not empty, the remaining
+ *  ranges and the best results are written to it every checkpoint_interval seconds and when the sweep finishes.
+ *
+ *  The results are added to results, and the number of evaluations is returned.
+ */
+uint64_t parameter_sweep(const SweepGrid &grid, double (*objective_function)(const std::vector<double> &), const vector< pair<uint64_t, uint64_t> > &ranges, uint32_t number_threads, uint64_t chunk_size, SweepResults &results, const string &checkpoint_filename, uint32_t checkpoint_interval);
+
+void write_sweep_checkpoint(const string &checkpoint_filename, const SweepGrid &grid, const vector< pair<uint64_t, uint64_t> > &ranges, const SweepResults &results) throw (string);
+bool read_sweep_checkpoint(const string &checkpoint_filename, const SweepGrid &grid, vector< pair<uint64_t, uint64_t> > &ranges, SweepResults &results) throw (string);
+
+void print_sweep_results(const SweepGrid &grid, const SweepResults &results);
+
+/**
+ *  Arguments:
+ *      --sweep_threads <i>                 number of threads, 0 uses all cores (default 1, the objective function must be thread safe to use more)
+ *      --sweep_best <i>                    number of best points to keep (default 10)
+ *      --sweep_chunk_size <i>              indices evaluated by a thread before checking for more work (default depends on the grid size)
+ *      --sweep_checkpoint <file>           checkpoint file, the sweep resumes from it if it exists
+ *      --sweep_checkpoint_interval <i>     seconds between checkpoints (default 300)
+ *      --sweep_refine_levels <i>           coarse to fine refinement: after sweeping at step_size, repeatedly sweep the cells
+ *                                          around the --sweep_best points at a finer step size (default 0, no refinement)
+ *      --sweep_refine_factor <i>           step size is divided by this integer for each level of refinement (default 4)
+ */
+void parameter_sweep(const vector<string> &arguments, const std::vector<double> &min_bound, const std::vector<double> &max_bound, const std::vector<double> &step_size, double (*objective_function)(const std::vector<double> &));
+
 void parameter_sweep(const std::vector<double> &min_bound, const std::vector<double> &max_bound, const std::vector<double> &step_size, double (*objective_function)(const std::vector<double> &));
 
 #endif
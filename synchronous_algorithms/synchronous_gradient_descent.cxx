@@ -28,6 +28,8 @@ void synchronous_gradient_descent(vector<string> arguments, double (*objective_f
         if (!quiet) cerr << "Argument ''--min_improvement <f>' not found, using default of " << min_improvement << endl;
     }
 
+    GradientEstimator gradient_estimator(arguments);
+
     vector<double> point(starting_point);
     vector<double> new_point(starting_point);
     vector<double> gradient(starting_point.size(), 0.0);
@@ -38,7 +40,7 @@ void synchronous_gradient_descent(vector<string> arguments, double (*objective_f
     for (uint32_t i = 0; max_iterations == 0 || i < max_iterations; i++) {
         if (!quiet) cout << "iteration " << i << " -- fitness : [point] -- " << current_fitness << " : " << vector_to_string(point) << endl;
 
-        get_gradient(objective_function, point, step_size, gradient);
+        gradient_estimator.estimate(objective_function, point, step_size, gradient);
 
         try {
             line_search.line_search(point, current_fitness, gradient, new_point, current_fitness);
@@ -105,6 +107,8 @@ void synchronous_conjugate_gradient_descent(vector<string> arguments, double (*o
         cerr << "Argument ''--min_improvement <f>' not found, using default of " << min_improvement << endl;
     }
 
+    GradientEstimator gradient_estimator(arguments);
+
     vector<double> point(starting_point);
     vector<double> new_point(starting_point);
     vector<double> previous_gradient(starting_point.size(), 0.0);
@@ -119,7 +123,7 @@ void synchronous_conjugate_gradient_descent(vector<string> arguments, double (*o
     for (uint32_t i = 0; max_iterations == 0 || i < max_iterations; i++) {
         cout << "iteration " << i << " -- fitness : [point] -- " << current_fitness << " : " << vector_to_string(point) << endl;
 
-        get_gradient(objective_function, point, step_size, gradient);
+        gradient_estimator.estimate(objective_function, point, step_size, gradient);
 
         if (i > 0 && reset != 0) {
             // bet = g_pres' * (g_pres - g_prev) / (g_prev' * g_prev);
@@ -50,7 +50,7 @@ void synchronous_newton_method(vector<string> arguments, double (*objective_func
             get_gradient(objective_function, point, step_size, gradient);
             get_hessian(objective_function, point, step_size, hessian);
             newton_step(hessian, gradient, direction);
-        } catch (const char *err_msg) {
+        } catch (string err_msg) {
             cout << "\tCalculating gradient and hessian failed with message: [" << err_msg << "]" << endl;
             break;
         }
@@ -0,0 +1,255 @@
+#include <vector>
+#include <iostream>
+#include <string>
+
+#include <cmath>
+
+#include "stdint.h"
+
+#include "synchronous_algorithms/synchronous_quasi_newton_method.hxx"
+#include "synchronous_algorithms/gradient.hxx"
+#include "synchronous_algorithms/line_search.hxx"
+
+#include "util/vector_io.hxx"
+#include "util/arguments.hxx"
+
+using namespace std;
+
+/**
+ *  The search maximizes the objective function, so the updates are done for the minimization of its
+ *  negation. With g the gradient of the objective function, s the change in the point and y the change
+ *  in the negated gradient (previous g - current g), H approximates the inverse hessian of the negated
+ *  objective function and the ascent direction is H * g.
+ */
+static double dot_product(const vector<double> &v1, const vector<double> &v2) {
+    double result = 0.0;
+    for (uint32_t i = 0; i < v1.size(); i++) result += v1[i] * v2[i];
+    return result;
+}
+
+/**
+ *  H = (I - rho * s * y^T) * H * (I - rho * y * s^T) + rho * s * s^T, with rho = 1 / (y^T * s)
+ */
+static void bfgs_update(const vector<double> &s, const vector<double> &y, vector< vector<double> > &inverse_hessian) {
+    uint32_t n = s.size();
+    double rho = 1.0 / dot_product(y, s);
+
+    vector<double> Hy(n, 0.0);
+    for (uint32_t i = 0; i < n; i++) Hy[i] = dot_product(inverse_hessian[i], y);
+    double yHy = dot_product(y, Hy);
+
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            inverse_hessian[i][j] += rho * ((1.0 + rho * yHy) * s[i] * s[j] - Hy[i] * s[j] - s[i] * Hy[j]);
+        }
+    }
+}
+
+/**
+ *  The L-BFGS two loop recursion, calculates H * g from the stored s and y vectors (oldest first).
+ */
+static void lbfgs_direction(const vector< vector<double> > &s_history, const vector< vector<double> > &y_history, const vector<double> &gradient, vector<double> &direction) {
+    uint32_t m = s_history.size();
+    vector<double> alpha(m, 0.0);
+    vector<double> rho(m, 0.0);
+
+    direction.assign(gradient.begin(), gradient.end());
+
+    for (int32_t i = m - 1; i >= 0; i--) {
+        rho[i] = 1.0 / dot_product(y_history[i], s_history[i]);
+        alpha[i] = rho[i] * dot_product(s_history[i], direction);
+        for (uint32_t j = 0; j < direction.size(); j++) direction[j] -= alpha[i] * y_history[i][j];
+    }
+
+    //scale the initial inverse hessian approximation by the most recent curvature
+    if (m > 0) {
+        double gamma = dot_product(s_history[m - 1], y_history[m - 1]) / dot_product(y_history[m - 1], y_history[m - 1]);
+        for (uint32_t j = 0; j < direction.size(); j++) direction[j] *= gamma;
+    }
+
+    for (uint32_t i = 0; i < m; i++) {
+        double beta = rho[i] * dot_product(y_history[i], direction);
+        for (uint32_t j = 0; j < direction.size(); j++) direction[j] += s_history[i][j] * (alpha[i] - beta);
+    }
+}
+
+/**
+ *  If memory is 0, a full (n x n) inverse hessian approximation is used (BFGS), otherwise
+ *  only the last memory s and y vectors are kept (L-BFGS).
+ */
+static void synchronous_quasi_newton_method(vector<string> arguments, double (*objective_function)(const std::vector<double> &), const vector<double> &starting_point, const vector<double> &step_size, LineSearch &line_search, uint32_t memory) {
+    uint32_t max_iterations = 0;
+    if ( !get_argument(arguments, "--max_iterations", false, max_iterations) ) {
+        cerr << "Argument '--max_iterations <i>' not found, synchronous quasi-newton method could potentially run forever." << endl;
+    }
+
+    double min_improvement = 1e-5;
+    if ( !get_argument(arguments, "--min_improvement", false, min_improvement) ) {
+        cerr << "Argument ''--min_improvement <f>' not found, using default of " << min_improvement << endl;
+    }
+
+    uint32_t number_parameters = starting_point.size();
+
+    vector<double> point(starting_point);
+    vector<double> new_point(number_parameters, 0.0);
+    vector<double> direction(number_parameters, 0.0);
+    vector<double> gradient(number_parameters, 0.0);
+    vector<double> new_gradient(number_parameters, 0.0);
+    vector<double> s(number_parameters, 0.0);
+    vector<double> y(number_parameters, 0.0);
+
+    //used by BFGS
+    vector< vector<double> > inverse_hessian;
+    bool inverse_hessian_scaled = false;
+    if (memory == 0) {
+        inverse_hessian.assign(number_parameters, vector<double>(number_parameters, 0.0));
+        for (uint32_t i = 0; i < number_parameters; i++) inverse_hessian[i][i] = 1.0;
+    }
+
+    //used by L-BFGS
+    vector< vector<double> > s_history;
+    vector< vector<double> > y_history;
+
+    double current_fitness = objective_function(point);
+    double previous_fitness = current_fitness;
+
+    cout.precision(15);
+
+    get_gradient(objective_function, point, step_size, gradient);
+
+    for (uint32_t i = 0; max_iterations == 0 || i < max_iterations; i++) {
+        cout << "iteration " << i << " -- fitness : [point] -- " << current_fitness << " : " << vector_to_string(point) << endl;
+
+        if (memory == 0) {
+            for (uint32_t j = 0; j < number_parameters; j++) direction[j] = dot_product(inverse_hessian[j], gradient);
+        } else {
+            lbfgs_direction(s_history, y_history, gradient, direction);
+        }
+
+        //if the approximation no longer gives an ascent direction, restart from the gradient
+        if (dot_product(direction, gradient) <= 0.0) {
+            cout << "\t\tquasi-newton direction is not an ascent direction, resetting to the gradient" << endl;
+
+            if (memory == 0) {
+                for (uint32_t j = 0; j < number_parameters; j++) {
+                    for (uint32_t k = 0; k < number_parameters; k++) inverse_hessian[j][k] = 0.0;
+                    inverse_hessian[j][j] = 1.0;
+                }
+                inverse_hessian_scaled = false;
+            } else {
+                s_history.clear();
+                y_history.clear();
+            }
+            direction.assign(gradient.begin(), gradient.end());
+        }
+
+        cout << "\t\tdirection: " << vector_to_string(direction) << endl;
+
+        try {
+            line_search.line_search(point, current_fitness, direction, new_point, current_fitness);
+        } catch (LineSearchException *lse) {
+            cout << "\tLINE SEARCH EXCEPTION: " << *lse << endl;
+
+            if (lse->get_type() != LineSearchException::LOOP_2_OUT_OF_BOUNDS && lse->get_type() != LineSearchException::LOOP_3_OUT_OF_BOUNDS) {
+                delete lse;
+                break; //dont quit for out of bounds errors
+            } else {
+                delete lse;
+            }
+        }
+
+        cout << "\tnew fitness : [point] -- " << current_fitness << " : " << vector_to_string(new_point) << endl;
+
+        get_gradient(objective_function, new_point, step_size, new_gradient);
+
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            s[j] = new_point[j] - point[j];
+            y[j] = gradient[j] - new_gradient[j];
+        }
+
+        //only update the approximation if the curvature condition holds, otherwise it would not remain positive definite
+        double sy = dot_product(s, y);
+        if (sy > 1e-12 * sqrt(dot_product(s, s) * dot_product(y, y))) {
+            if (memory == 0) {
+                if (!inverse_hessian_scaled) {
+                    //scale the initial identity matrix by the first curvature estimate
+                    double gamma = sy / dot_product(y, y);
+                    for (uint32_t j = 0; j < number_parameters; j++) inverse_hessian[j][j] *= gamma;
+                    inverse_hessian_scaled = true;
+                }
+                bfgs_update(s, y, inverse_hessian);
+            } else {
+                if (s_history.size() == memory) {
+                    s_history.erase(s_history.begin());
+                    y_history.erase(y_history.begin());
+                }
+                s_history.push_back(s);
+                y_history.push_back(y);
+            }
+        }
+
+        point.assign(new_point.begin(), new_point.end());
+        gradient.assign(new_gradient.begin(), new_gradient.end());
+
+        if (fabs(current_fitness - previous_fitness) < min_improvement) {
+            cout << "Search terminating because (current fitness (" << current_fitness << ") - previous fitness (" << previous_fitness << ") == " << fabs(current_fitness - previous_fitness) << ") < minimum improvement (" << min_improvement << ")" << endl;
+            break;
+        }
+        previous_fitness = current_fitness;
+    }
+}
+
+static uint32_t get_lbfgs_memory(const vector<string> &arguments) {
+    uint32_t memory = 10;
+    if (!get_argument(arguments, "--lbfgs_memory", false, memory)) {
+        cerr << "Argument '--lbfgs_memory <i>' not found, using default of " << memory << endl;
+    }
+
+    if (memory == 0) {
+        cerr << "Argument '--lbfgs_memory <i>' must be greater than 0." << endl;
+        exit(1);
+    }
+    return memory;
+}
+
+void synchronous_bfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &)) {
+    vector<double> starting_point;
+    vector<double> step_size;
+
+    get_argument_vector<double>(arguments, "--starting_point", true, starting_point);
+    get_argument_vector<double>(arguments, "--step_size", true, step_size);
+
+    LineSearch line_search(objective_function, arguments);
+    synchronous_quasi_newton_method(arguments, objective_function, starting_point, step_size, line_search, 0);
+}
+
+void synchronous_bfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &), const vector<double> &starting_point, const vector<double> &step_size) {
+    LineSearch line_search(objective_function, arguments);
+    synchronous_quasi_newton_method(arguments, objective_function, starting_point, step_size, line_search, 0);
+}
+
+void synchronous_bfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &), const vector<double> &min_bound, const vector<double> &max_bound, const vector<double> &starting_point, const vector<double> &step_size) {
+    LineSearch line_search(objective_function, min_bound, max_bound, arguments);
+    synchronous_quasi_newton_method(arguments, objective_function, starting_point, step_size, line_search, 0);
+}
+
+void synchronous_lbfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &)) {
+    vector<double> starting_point;
+    vector<double> step_size;
+
+    get_argument_vector<double>(arguments, "--starting_point", true, starting_point);
+    get_argument_vector<double>(arguments, "--step_size", true, step_size);
+
+    LineSearch line_search(objective_function, arguments);
+    synchronous_quasi_newton_method(arguments, objective_function, starting_point, step_size, line_search, get_lbfgs_memory(arguments));
+}
+
+void synchronous_lbfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &), const vector<double> &starting_point, const vector<double> &step_size) {
+    LineSearch line_search(objective_function, arguments);
+    synchronous_quasi_newton_method(arguments, objective_function, starting_point, step_size, line_search, get_lbfgs_memory(arguments));
+}
+
+void synchronous_lbfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &), const vector<double> &min_bound, const vector<double> &max_bound, const vector<double> &starting_point, const vector<double> &step_size) {
+    LineSearch line_search(objective_function, min_bound, max_bound, arguments);
+    synchronous_quasi_newton_method(arguments, objective_function, starting_point, step_size, line_search, get_lbfgs_memory(arguments));
+}
@@ -0,0 +1,30 @@
+#ifndef TAO_QUASI_NEWTON_METHOD_H
+#define TAO_QUASI_NEWTON_METHOD_H
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+/**
+ *  BFGS keeps an approximation of the inverse hessian which is updated from the change in the gradient
+ *  between iterations, so only the gradient (2n objective function evaluations) is calculated each
+ *  iteration instead of the gradient and hessian as in synchronous_newton_method.
+ */
+void synchronous_bfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &));
+
+void synchronous_bfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &), const vector<double> &starting_point, const vector<double> &step_size);
+
+void synchronous_bfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &), const vector<double> &min_bound, const vector<double> &max_bound, const vector<double> &starting_point, const vector<double> &step_size);
+
+/**
+ *  L-BFGS only keeps the last m (--lbfgs_memory) changes in the point and gradient instead of the
+ *  n x n inverse hessian approximation, so memory is O(m * n).
+ */
+void synchronous_lbfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &));
+
+void synchronous_lbfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &), const vector<double> &starting_point, const vector<double> &step_size);
+
+void synchronous_lbfgs(vector<string> arguments, double (*objective_function)(const std::vector<double> &), const vector<double> &min_bound, const vector<double> &max_bound, const vector<double> &starting_point, const vector<double> &step_size);
+
+#endif
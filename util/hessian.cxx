@@ -1,5 +1,6 @@
 #include <iostream>
 #include <vector>
+#include <cmath>
 
 #include "stdint.h"
 
@@ -15,6 +16,7 @@
 using std::vector;
 using std::cout;
 using std::endl;
+using std::string;
 
 //using namespace boost::numeric::ublas; 
 
@@ -213,3 +215,325 @@ void randomized_hessian(const vector< vector<double> > &actual_points, const vec
         }
     }
 }
+
+/**
+ *  Solves the (weighted) least squares problem X * W = Y using the normal equations
+ *  (X^T * D * X) * W = X^T * D * Y, where D is the diagonal of the weights (all 1 if weights is empty).
+ *  X^T * D * X and X^T * D * Y are accumulated directly so X^T is never created.
+ */
+static void least_squares(const vector< vector<double> > &X, const vector<double> &Y, const vector<double> &weights, vector<double> &W) throw (string) {
+    uint32_t x_len = X[0].size();
+
+    vector< vector<double> > XTX(x_len, vector<double>(x_len, 0.0));
+    vector<double> XTY(x_len, 0.0);
+
+    for (uint32_t i = 0; i < X.size(); i++) {
+        double weight = weights.empty() ? 1.0 : weights[i];
+        if (weight == 0.0) continue;
+
+        for (uint32_t j = 0; j < x_len; j++) {
+            if (X[i][j] == 0.0) continue;
+
+            double wx = weight * X[i][j];
+            XTY[j] += wx * Y[i];
+            for (uint32_t k = j; k < x_len; k++) {
+                XTX[j][k] += wx * X[i][k];
+            }
+        }
+    }
+
+    for (uint32_t j = 0; j < x_len; j++) {
+        for (uint32_t k = 0; k < j; k++) XTX[j][k] = XTX[k][j];
+    }
+
+    vector< vector<double> > LU;
+    vector<uint32_t> P;
+    LUP_decomposition(XTX, LU, P);
+    LUP_solve(LU, P, XTY, W);
+}
+
+static void center_points(const vector< vector<double> > &actual_points, const vector<double> &center, vector< vector<double> > &points) {
+    points.assign(actual_points.begin(), actual_points.end());
+    for (uint32_t i = 0; i < points.size(); i++) {
+        for (uint32_t j = 0; j < points[i].size(); j++) {
+            points[i][j] = center[j] - points[i][j];
+        }
+    }
+}
+
+/**
+ *  Weighted version of the full quadratic model, using the same terms as randomized_hessian:
+ *	X = [1, x1, ... xn, 0.5*x1^2, ... 0.5*xn^2, x1*x2, ..., x1*xn, x2*x3, ..., x2*xn, ...]
+ */
+void randomized_hessian(const vector< vector<double> > &actual_points, const vector<double> &center, const vector<double> &fitness, const vector<double> &weights, vector< vector<double> > &hessian, vector<double> &gradient) throw (string) {
+    vector< vector<double> > points;
+    center_points(actual_points, center, points);
+
+    uint32_t number_parameters = center.size();
+    uint32_t x_len = 1 + number_parameters + number_parameters + ((number_parameters * (number_parameters - 1)) / 2);
+
+    vector< vector<double> > X(points.size(), vector<double>(x_len, 0.0));
+
+    for (uint32_t i = 0; i < points.size(); i++) {
+        X[i][0] = 1;
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            X[i][1+j] = points[i][j];
+            X[i][1+number_parameters+j] = 0.5 * points[i][j] * points[i][j];
+        }
+        uint32_t current = 1 + number_parameters + number_parameters;
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            for (uint32_t k = j+1; k < number_parameters; k++) {
+                X[i][current++] = points[i][j] * points[i][k];
+            }
+        }
+    }
+
+    vector<double> W;
+    least_squares(X, fitness, weights, W);
+
+    gradient.resize(number_parameters);
+    hessian.assign(number_parameters, vector<double>(number_parameters, 0.0));
+
+    for (uint32_t i = 0; i < number_parameters; i++) {
+        gradient[i] = W[1+i];
+        hessian[i][i] = W[1+number_parameters+i];
+    }
+
+    uint32_t current = 1 + number_parameters + number_parameters;
+    for (uint32_t j = 0; j < number_parameters; j++) {
+        for (uint32_t k = j+1; k < number_parameters; k++) {
+            hessian[j][k] = W[current];
+            hessian[k][j] = W[current];
+            current++;
+        }
+    }
+}
+
+/**
+ *	X = [1, x1, ... xn, 0.5*x1^2, ... 0.5*xn^2]
+ */
+void randomized_diagonal_hessian(const vector< vector<double> > &actual_points, const vector<double> &center, const vector<double> &fitness, const vector<double> &weights, vector<double> &hessian_diagonal, vector<double> &gradient) throw (string) {
+    vector< vector<double> > points;
+    center_points(actual_points, center, points);
+
+    uint32_t number_parameters = center.size();
+    uint32_t x_len = 1 + number_parameters + number_parameters;
+
+    vector< vector<double> > X(points.size(), vector<double>(x_len, 0.0));
+
+    for (uint32_t i = 0; i < points.size(); i++) {
+        X[i][0] = 1;
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            X[i][1+j] = points[i][j];
+            X[i][1+number_parameters+j] = 0.5 * points[i][j] * points[i][j];
+        }
+    }
+
+    vector<double> W;
+    least_squares(X, fitness, weights, W);
+
+    gradient.resize(number_parameters);
+    hessian_diagonal.resize(number_parameters);
+
+    for (uint32_t i = 0; i < number_parameters; i++) {
+        gradient[i] = W[1+i];
+        hessian_diagonal[i] = W[1+number_parameters+i];
+    }
+}
+
+void get_block_members(const vector<uint32_t> &blocks, vector< vector<uint32_t> > &members) {
+    uint32_t number_blocks = 0;
+    for (uint32_t i = 0; i < blocks.size(); i++) {
+        if (blocks[i] + 1 > number_blocks) number_blocks = blocks[i] + 1;
+    }
+
+    members.assign(number_blocks, vector<uint32_t>());
+    for (uint32_t i = 0; i < blocks.size(); i++) members[blocks[i]].push_back(i);
+}
+
+uint32_t block_hessian_terms(const vector<uint32_t> &blocks) {
+    vector< vector<uint32_t> > members;
+    get_block_members(blocks, members);
+
+    uint32_t x_len = 1 + blocks.size();
+    for (uint32_t b = 0; b < members.size(); b++) {
+        uint32_t size = members[b].size();
+        x_len += size + ((size * (size - 1)) / 2);
+    }
+    return x_len;
+}
+
+/**
+ *	X = [1, x1, ... xn, (for each block) 0.5*xi^2 ... 0.5*xj^2, xi*x(i+1), ..., x(j-1)*xj]
+ */
+void randomized_block_hessian(const vector< vector<double> > &actual_points, const vector<double> &center, const vector<double> &fitness, const vector<double> &weights, const vector<uint32_t> &blocks, vector< vector< vector<double> > > &block_hessians, vector<double> &gradient) throw (string) {
+    vector< vector<double> > points;
+    center_points(actual_points, center, points);
+
+    uint32_t number_parameters = center.size();
+
+    vector< vector<uint32_t> > members;
+    get_block_members(blocks, members);
+
+    uint32_t x_len = block_hessian_terms(blocks);
+
+    vector< vector<double> > X(points.size(), vector<double>(x_len, 0.0));
+
+    for (uint32_t i = 0; i < points.size(); i++) {
+        X[i][0] = 1;
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            X[i][1+j] = points[i][j];
+        }
+
+        uint32_t current = 1 + number_parameters;
+        for (uint32_t b = 0; b < members.size(); b++) {
+            for (uint32_t j = 0; j < members[b].size(); j++) {
+                X[i][current++] = 0.5 * points[i][members[b][j]] * points[i][members[b][j]];
+            }
+            for (uint32_t j = 0; j < members[b].size(); j++) {
+                for (uint32_t k = j+1; k < members[b].size(); k++) {
+                    X[i][current++] = points[i][members[b][j]] * points[i][members[b][k]];
+                }
+            }
+        }
+    }
+
+    vector<double> W;
+    least_squares(X, fitness, weights, W);
+
+    gradient.resize(number_parameters);
+    for (uint32_t i = 0; i < number_parameters; i++) gradient[i] = W[1+i];
+
+    block_hessians.resize(members.size());
+
+    uint32_t current = 1 + number_parameters;
+    for (uint32_t b = 0; b < members.size(); b++) {
+        uint32_t size = members[b].size();
+        block_hessians[b].assign(size, vector<double>(size, 0.0));
+
+        for (uint32_t j = 0; j < size; j++) {
+            block_hessians[b][j][j] = W[current++];
+        }
+        for (uint32_t j = 0; j < size; j++) {
+            for (uint32_t k = j+1; k < size; k++) {
+                block_hessians[b][j][k] = W[current];
+                block_hessians[b][k][j] = W[current];
+                current++;
+            }
+        }
+    }
+}
+
+/**
+ *  Fits the diagonal model, then estimates each cross term from the residuals r of that fit:
+ *      H[j][k] = sum(r * xj * xk) / sum(xj^2 * xk^2)
+ *  which is unbiased for points sampled symmetrically around the center (the cross terms are
+ *  then uncorrelated with the diagonal model's terms). Only the rank largest magnitude eigenpairs
+ *  of the cross terms are kept, found by power iteration with deflation, so the hessian is
+ *      H = diag(hessian_diagonal) + sum(eigenvalues[r] * eigenvectors[r] * eigenvectors[r]^T)
+ */
+void randomized_low_rank_hessian(const vector< vector<double> > &actual_points, const vector<double> &center, const vector<double> &fitness, const vector<double> &weights, uint32_t rank, vector<double> &hessian_diagonal, vector< vector<double> > &eigenvectors, vector<double> &eigenvalues, vector<double> &gradient) throw (string) {
+    randomized_diagonal_hessian(actual_points, center, fitness, weights, hessian_diagonal, gradient);
+
+    vector< vector<double> > points;
+    center_points(actual_points, center, points);
+
+    uint32_t number_parameters = center.size();
+
+    vector< vector<double> > cross_terms(number_parameters, vector<double>(number_parameters, 0.0));
+    vector< vector<double> > cross_weights(number_parameters, vector<double>(number_parameters, 0.0));
+
+    //the constant term is the (weighted) mean residual of the linear and diagonal terms
+    vector<double> partial(points.size(), 0.0);
+    double constant = 0.0, total_weight = 0.0;
+    for (uint32_t i = 0; i < points.size(); i++) {
+        double weight = weights.empty() ? 1.0 : weights[i];
+
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            partial[i] += gradient[j] * points[i][j] + 0.5 * hessian_diagonal[j] * points[i][j] * points[i][j];
+        }
+        constant += weight * (fitness[i] - partial[i]);
+        total_weight += weight;
+    }
+    if (total_weight > 0.0) constant /= total_weight;
+
+    for (uint32_t i = 0; i < points.size(); i++) {
+        double weight = weights.empty() ? 1.0 : weights[i];
+        double residual = fitness[i] - constant - partial[i];
+
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            for (uint32_t k = j+1; k < number_parameters; k++) {
+                double xjk = points[i][j] * points[i][k];
+                cross_terms[j][k] += weight * residual * xjk;
+                cross_weights[j][k] += weight * xjk * xjk;
+            }
+        }
+    }
+
+    for (uint32_t j = 0; j < number_parameters; j++) {
+        for (uint32_t k = j+1; k < number_parameters; k++) {
+            if (cross_weights[j][k] > 0.0) cross_terms[j][k] /= cross_weights[j][k];
+            cross_terms[k][j] = cross_terms[j][k];
+        }
+    }
+
+    if (rank > number_parameters) rank = number_parameters;
+
+    eigenvectors.assign(rank, vector<double>(number_parameters, 0.0));
+    eigenvalues.assign(rank, 0.0);
+
+    vector<double> next(number_parameters, 0.0);
+    for (uint32_t r = 0; r < rank; r++) {
+        vector<double> &v = eigenvectors[r];
+        for (uint32_t j = 0; j < number_parameters; j++) v[j] = 1.0 + 0.1 * ((j + r) % 3);
+
+        double lambda = 0.0;
+        for (uint32_t iteration = 0; iteration < 200; iteration++) {
+            double norm = 0.0;
+            for (uint32_t j = 0; j < number_parameters; j++) norm += v[j] * v[j];
+            norm = sqrt(norm);
+            if (norm == 0.0) break;
+            for (uint32_t j = 0; j < number_parameters; j++) v[j] /= norm;
+
+            for (uint32_t j = 0; j < number_parameters; j++) {
+                next[j] = 0.0;
+                for (uint32_t k = 0; k < number_parameters; k++) next[j] += cross_terms[j][k] * v[k];
+            }
+
+            double new_lambda = 0.0;
+            for (uint32_t j = 0; j < number_parameters; j++) new_lambda += v[j] * next[j];
+
+            v.assign(next.begin(), next.end());
+
+            if (fabs(new_lambda - lambda) <= 1e-10 * fabs(new_lambda)) {
+                lambda = new_lambda;
+                break;
+            }
+            lambda = new_lambda;
+        }
+
+        double norm = 0.0;
+        for (uint32_t j = 0; j < number_parameters; j++) norm += v[j] * v[j];
+        norm = sqrt(norm);
+        if (norm == 0.0) {
+            eigenvalues[r] = 0.0;
+            continue;
+        }
+        for (uint32_t j = 0; j < number_parameters; j++) v[j] /= norm;
+        eigenvalues[r] = lambda;
+
+        //deflate so the next eigenpair can be found
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            for (uint32_t k = 0; k < number_parameters; k++) {
+                cross_terms[j][k] -= lambda * v[j] * v[k];
+            }
+        }
+    }
+
+    //the cross terms have no diagonal, so remove what the low rank part adds to it
+    for (uint32_t r = 0; r < rank; r++) {
+        for (uint32_t j = 0; j < number_parameters; j++) {
+            hessian_diagonal[j] -= eigenvalues[r] * eigenvectors[r][j] * eigenvectors[r][j];
+        }
+    }
+}
@@ -4,6 +4,8 @@
 #include <vector>
 #include <string>
 
+#include "stdint.h"
+
 using std::vector;
 using std::string;
 
@@ -11,4 +13,26 @@ void get_hessian(double (*objective_function)(const std::vector<double> &), cons
 
 void randomized_hessian(const vector< vector<double> > &actual_points, const vector<double> &center, const vector<double> &fitness, vector< vector<double> > &hessian, vector<double> &gradient) throw (string);
 
+/**
+ *  The following regressions take a weight for each point (weighted least squares),
+ *  an empty weights vector weights every point equally.
+ */
+void randomized_hessian(const vector< vector<double> > &actual_points, const vector<double> &center, const vector<double> &fitness, const vector<double> &weights, vector< vector<double> > &hessian, vector<double> &gradient) throw (string);
+
+/**
+ *  Reduced regression models for high dimensional problems, these fit far fewer terms than
+ *  the full quadratic model used by randomized_hessian:
+ *      diagonal:   1 + 2n terms, no cross terms
+ *      block:      cross terms only between parameters in the same block (blocks[i] is the block of parameter i)
+ *      low rank:   the diagonal model, plus the rank largest eigenpairs of the cross terms estimated from its residuals
+ */
+void randomized_diagonal_hessian(const vector< vector<double> > &actual_points, const vector<double> &center, const vector<double> &fitness, const vector<double> &weights, vector<double> &hessian_diagonal, vector<double> &gradient) throw (string);
+
+void randomized_block_hessian(const vector< vector<double> > &actual_points, const vector<double> &center, const vector<double> &fitness, const vector<double> &weights, const vector<uint32_t> &blocks, vector< vector< vector<double> > > &block_hessians, vector<double> &gradient) throw (string);
+
+void randomized_low_rank_hessian(const vector< vector<double> > &actual_points, const vector<double> &center, const vector<double> &fitness, const vector<double> &weights, uint32_t rank, vector<double> &hessian_diagonal, vector< vector<double> > &eigenvectors, vector<double> &eigenvalues, vector<double> &gradient) throw (string);
+
+uint32_t block_hessian_terms(const vector<uint32_t> &blocks);
+void get_block_members(const vector<uint32_t> &blocks, vector< vector<uint32_t> > &members);
+
 #endif
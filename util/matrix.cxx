@@ -127,7 +127,7 @@ void LUP_decomposition(const vector<vector <double> > &A, vector <vector <double
 		}
 
 		//This is a singular matrix.
-		if (p == 0) throw "Singular matrix passed to LUP_decomposition";
+		if (p == 0) throw string("Singular matrix passed to LUP_decomposition");
 
 		swap(uint32_t, P[k], P[k_prime]);
 		for (uint32_t i = 0; i < length; i++) {
@@ -1,11 +1,96 @@
 #include <vector>
+#include <sstream>
 
 #include "util/newton_step.hxx"
+#include "util/hessian.hxx"
 #include "util/matrix.hxx"
 
 using std::vector;
+using std::ostringstream;
 
 void newton_step(const vector< vector<double> > &hessian, const vector<double> &gradient, vector<double> &step) throw (string) { 
 	vector< vector<double> > inverse_hessian = matrix_invert(hessian);
 	step = matrix_vector_multiply(inverse_hessian, gradient);
 }
+
+void diagonal_newton_step(const vector<double> &hessian_diagonal, const vector<double> &gradient, vector<double> &step) throw (string) {
+    step.resize(gradient.size());
+
+    for (uint32_t i = 0; i < gradient.size(); i++) {
+        if (hessian_diagonal[i] == 0.0) {
+            ostringstream err_msg;
+            err_msg << "diagonal newton step error, hessian_diagonal[" << i << "] was 0";
+            throw err_msg.str();
+        }
+        step[i] = gradient[i] / hessian_diagonal[i];
+    }
+}
+
+void block_newton_step(const vector<uint32_t> &blocks, const vector< vector< vector<double> > > &block_hessians, const vector<double> &gradient, vector<double> &step) throw (string) {
+    vector< vector<uint32_t> > members;
+    get_block_members(blocks, members);
+
+    step.resize(gradient.size());
+
+    for (uint32_t b = 0; b < members.size(); b++) {
+        if (members[b].size() == 0) continue;
+
+        vector<double> block_gradient(members[b].size());
+        for (uint32_t j = 0; j < members[b].size(); j++) block_gradient[j] = gradient[members[b][j]];
+
+        vector< vector<double> > LU;
+        vector<uint32_t> P;
+        vector<double> block_step;
+        LUP_decomposition(block_hessians[b], LU, P);
+        LUP_solve(LU, P, block_gradient, block_step);
+
+        for (uint32_t j = 0; j < members[b].size(); j++) step[members[b][j]] = block_step[j];
+    }
+}
+
+/**
+ *  Uses the Woodbury identity with H = D + V^T * L * V (V holds the eigenvectors as rows):
+ *      H^-1 * g = D^-1 * g - D^-1 * V^T * (L^-1 + V * D^-1 * V^T)^-1 * V * D^-1 * g
+ *  so only a rank x rank system is solved.
+ */
+void low_rank_newton_step(const vector<double> &hessian_diagonal, const vector< vector<double> > &eigenvectors, const vector<double> &eigenvalues, const vector<double> &gradient, vector<double> &step) throw (string) {
+    diagonal_newton_step(hessian_diagonal, gradient, step);
+
+    vector<uint32_t> used;
+    for (uint32_t r = 0; r < eigenvalues.size(); r++) {
+        if (eigenvalues[r] != 0.0) used.push_back(r);
+    }
+    if (used.size() == 0) return;
+
+    uint32_t number_parameters = gradient.size();
+    uint32_t rank = used.size();
+
+    vector< vector<double> > capacitance(rank, vector<double>(rank, 0.0));
+    vector<double> projected(rank, 0.0);
+
+    for (uint32_t r = 0; r < rank; r++) {
+        const vector<double> &vr = eigenvectors[used[r]];
+
+        for (uint32_t j = 0; j < number_parameters; j++) projected[r] += vr[j] * step[j];
+
+        capacitance[r][r] = 1.0 / eigenvalues[used[r]];
+        for (uint32_t s = 0; s < rank; s++) {
+            const vector<double> &vs = eigenvectors[used[s]];
+            for (uint32_t j = 0; j < number_parameters; j++) {
+                capacitance[r][s] += vr[j] * vs[j] / hessian_diagonal[j];
+            }
+        }
+    }
+
+    vector< vector<double> > LU;
+    vector<uint32_t> P;
+    vector<double> correction;
+    LUP_decomposition(capacitance, LU, P);
+    LUP_solve(LU, P, projected, correction);
+
+    for (uint32_t j = 0; j < number_parameters; j++) {
+        double sum = 0.0;
+        for (uint32_t r = 0; r < rank; r++) sum += eigenvectors[used[r]][j] * correction[r];
+        step[j] -= sum / hessian_diagonal[j];
+    }
+}
@@ -4,9 +4,20 @@
 #include <vector>
 #include <string>
 
+#include "stdint.h"
+
 using std::vector;
 using std::string;
 
 void newton_step(const vector< vector<double> > &hessian, const vector<double> &gradient, vector<double> &step) throw (string);
 
+/**
+ *  Newton steps for the reduced hessian models in util/hessian.hxx, these never build or invert the full hessian.
+ */
+void diagonal_newton_step(const vector<double> &hessian_diagonal, const vector<double> &gradient, vector<double> &step) throw (string);
+
+void block_newton_step(const vector<uint32_t> &blocks, const vector< vector< vector<double> > > &block_hessians, const vector<double> &gradient, vector<double> &step) throw (string);
+
+void low_rank_newton_step(const vector<double> &hessian_diagonal, const vector< vector<double> > &eigenvectors, const vector<double> &eigenvalues, const vector<double> &gradient, vector<double> &step) throw (string);
+
 #endif
@@ -135,5 +135,6 @@ template string vector_to_string(const vector<string> &v);
 template string vector_2d_to_string(const vector< vector<double> > &v);
 
 template void string_to_vector<double>(string s, vector<double> &v);
+template void string_to_vector<uint32_t>(string s, vector<uint32_t> &v);
 template void string_to_vector<uint64_t>(string s, vector<uint64_t> &v);
 